@@ -0,0 +1,208 @@
+#include "async_game.hpp"
+#include "core.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+struct BenchResult {
+    std::string name;
+    int npcs;
+    int iterations;
+    double mean_ms;
+    double min_ms;
+    std::string note;
+};
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+static const double MIN_BENCH_SECONDS = 0.2;
+static const int MAX_ITERATIONS = 20;
+static const int SIMULATE_REFERENCE_NPCS = 100000;
+static const double SIMULATE_RANGE = 10.0;
+
+static int map_size_for(int npcs) {
+    return std::max(100, static_cast<int>(std::sqrt(static_cast<double>(npcs)) * 10));
+}
+
+static BenchResult measure(const std::string& name, int npcs,
+                           const std::function<void()>& setup,
+                           const std::function<void()>& body) {
+    BenchResult result{name, npcs, 0, 0.0, 0.0, ""};
+    double total = 0.0;
+    double best = 0.0;
+
+    while (result.iterations < MAX_ITERATIONS && (total < MIN_BENCH_SECONDS * 1000 || result.iterations < 3)) {
+        if (setup) setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        total += ms;
+        best = result.iterations == 0 ? ms : std::min(best, ms);
+        result.iterations++;
+        if (ms > MIN_BENCH_SECONDS * 1000 * 5) break;
+    }
+
+    result.mean_ms = total / result.iterations;
+    result.min_ms = best;
+    return result;
+}
+
+// Core NPCs live on a fixed 500x500 map, so larger dungeons only get denser.
+// Past the reference size the battle range shrinks with the square root of the
+// count, which keeps the neighbours per NPC the same as on a proportionally
+// larger map.
+static double simulate_range_for(int npcs) {
+    if (npcs <= SIMULATE_REFERENCE_NPCS) return SIMULATE_RANGE;
+    return SIMULATE_RANGE * std::sqrt(static_cast<double>(SIMULATE_REFERENCE_NPCS) / npcs);
+}
+
+static void write_dungeon_csv(const std::string& filename, int npcs) {
+    static const char* types[] = {"Rogue", "Orc", "Werewolf"};
+    std::ofstream file(filename);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<> coord(0, 500);
+
+    for (int i = 0; i < npcs; ++i) {
+        const char* type = types[i % 3];
+        file << type << "," << type << "_" << i << "," << coord(rng) << "," << coord(rng) << ",1\n";
+    }
+}
+
+static void bench_async(int npcs, std::vector<BenchResult>& results) {
+    AsyncGame game(npcs, map_size_for(npcs));
+    game.set_console_log(false);
+
+    results.push_back(measure("movement_sweep", npcs, nullptr, [&]() {
+        game.movement_sweep();
+    }));
+
+    results.push_back(measure("kill_range_detection", npcs, nullptr, [&]() {
+        size_t pairs = 0;
+        for (size_t id = 0; id < game.get_npc_count(); ++id) {
+            pairs += game.find_targets(id).size();
+        }
+        volatile size_t sink = pairs;
+        (void)sink;
+    }));
+
+    results.push_back(measure("battle_resolution", npcs, [&]() {
+        game.movement_sweep();
+    }, [&]() {
+        game.resolve_battle_batch();
+        game.drain_log();
+    }));
+
+    std::streambuf* original = std::cout.rdbuf();
+    NullBuffer null_buffer;
+    std::cout.rdbuf(&null_buffer);
+    results.push_back(measure("map_render", npcs, nullptr, [&]() {
+        game.print_map();
+    }));
+    std::cout.rdbuf(original);
+}
+
+static void bench_core(int npcs, std::vector<BenchResult>& results) {
+    const std::string source = "bench_dungeon_in.csv";
+    const std::string target = "bench_dungeon_out.csv";
+    const std::string snapshot = "bench_dungeon.bfw";
+    write_dungeon_csv(source, npcs);
+
+    Core core;
+    core.setConsoleOutput(false);
+    core.setFileOutput(false);
+
+    results.push_back(measure("core_load", npcs, nullptr, [&]() {
+        core.loadFromFile(source);
+    }));
+
+    results.push_back(measure("core_save", npcs, nullptr, [&]() {
+        core.saveToFile(target);
+    }));
+    
+    results.push_back(measure("core_snapshot_save", npcs, nullptr, [&]() {
+        core.saveSnapshot(snapshot);
+    }));
+    
+    results.push_back(measure("core_snapshot_load", npcs, nullptr, [&]() {
+        core.loadSnapshot(snapshot);
+    }));
+
+    double range = simulate_range_for(npcs);
+    BenchResult simulate = measure("core_simulate_battle", npcs, [&]() {
+        core.loadFromFile(source);
+    }, [&]() {
+        core.simulateBattle(range);
+    });
+    if (range != SIMULATE_RANGE) {
+        std::ostringstream note;
+        note << "range " << std::setprecision(3) << range;
+        simulate.note = note.str();
+    }
+    results.push_back(simulate);
+
+    std::remove(source.c_str());
+    std::remove(target.c_str());
+    std::remove(snapshot.c_str());
+}
+
+static std::string to_json(const std::vector<BenchResult>& results) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"suite\": \"bench_lab7\",\n";
+    out << "  \"timestamp\": " << std::time(nullptr) << ",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"npcs\": " << r.npcs;
+        out << ", \"iterations\": " << r.iterations
+            << ", \"mean_ms\": " << r.mean_ms
+            << ", \"min_ms\": " << r.min_ms;
+        if (!r.note.empty()) out << ", \"note\": \"" << r.note << "\"";
+        out << "}";
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+int main(int argc, char** argv) {
+    std::string output = argc > 1 ? argv[1] : "bench_lab7.json";
+    std::vector<int> sizes = {1000, 10000, 100000, 1000000};
+    if (argc > 2) sizes = {std::max(1, std::atoi(argv[2]))};
+
+    std::vector<BenchResult> results;
+    for (int npcs : sizes) {
+        std::cerr << "Benchmarking " << npcs << " NPCs..." << std::endl;
+        bench_async(npcs, results);
+        bench_core(npcs, results);
+    }
+
+    for (const auto& r : results) {
+        std::cerr << std::setw(24) << std::left << r.name << std::right
+                  << std::setw(9) << r.npcs;
+        std::cerr << std::setw(12) << std::fixed << std::setprecision(3) << r.mean_ms << " ms"
+                  << "  (" << r.iterations << " runs";
+        if (!r.note.empty()) std::cerr << ", " << r.note;
+        std::cerr << ")" << std::endl;
+    }
+
+    std::ofstream file(output);
+    file << to_json(results);
+    std::cerr << "Results written to " << output << std::endl;
+    return 0;
+}
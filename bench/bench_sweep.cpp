@@ -0,0 +1,121 @@
+#include "async_game.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+static const int MAP_SIZE = 500;
+
+static double brute_force_detect_ms(AsyncGame& game, size_t& pairs) {
+    std::vector<AsyncNPC> npcs;
+    for (size_t id = 0; id < game.get_npc_count(); ++id) {
+        npcs.push_back(game.get_npc(id));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    pairs = 0;
+    for (size_t id = 0; id < npcs.size(); ++id) {
+        const auto& npc = npcs[id];
+        if (!npc.isAlive()) continue;
+        int kill_dist = game.get_kill_distance(npc.type);
+        for (size_t other_id = 0; other_id < npcs.size(); ++other_id) {
+            const auto& other = npcs[other_id];
+            if (other_id == id || !other.isAlive()) continue;
+            if (npc.distanceTo(other) <= kill_dist) pairs++;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static double grid_detect_ms(AsyncGame& game, size_t& pairs) {
+    auto start = std::chrono::steady_clock::now();
+
+    pairs = 0;
+    for (size_t id = 0; id < game.get_npc_count(); ++id) {
+        pairs += game.find_targets(id).size();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static double grid_sweep_ms(AsyncGame& game) {
+    auto start = std::chrono::steady_clock::now();
+    game.movement_sweep();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Fights the battles the last sweep found, outside the timed region, so every
+// timed sweep starts from a settled world as it would inside step().
+static void settle(AsyncGame& game) {
+    game.resolve_battle_batch();
+    game.drain_log();
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {1000, 2000, 5000, 10000, 20000};
+
+    std::cout << "Map " << MAP_SIZE << "x" << MAP_SIZE << std::endl;
+    std::cout << std::setw(8) << "NPCs"
+              << std::setw(16) << "sweep ms"
+              << std::setw(16) << "grid detect ms"
+              << std::setw(18) << "brute detect ms"
+              << std::setw(12) << "pairs" << std::endl;
+
+    for (int n : sizes) {
+        AsyncGame game(n, MAP_SIZE);
+        double sweep_ms = grid_sweep_ms(game);
+
+        size_t grid_pairs = 0;
+        size_t brute_pairs = 0;
+        double grid_ms = grid_detect_ms(game, grid_pairs);
+        double brute_ms = brute_force_detect_ms(game, brute_pairs);
+
+        std::cout << std::setw(8) << n
+                  << std::setw(16) << std::fixed << std::setprecision(2) << sweep_ms
+                  << std::setw(16) << grid_ms
+                  << std::setw(18) << brute_ms
+                  << std::setw(12) << grid_pairs
+                  << (grid_pairs == brute_pairs ? "" : "  MISMATCH") << std::endl;
+    }
+
+    const int scaling_npcs = 200000;
+    const int scaling_map = 2000;
+    int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (argc > 1) max_threads = std::max(1, std::atoi(argv[1]));
+
+    std::cout << "\nScaling: " << scaling_npcs << " NPCs, map "
+              << scaling_map << "x" << scaling_map << std::endl;
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "sweep ms"
+              << std::setw(12) << "speedup" << std::endl;
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        AsyncGame game(scaling_npcs, scaling_map);
+        game.set_console_log(false);
+        game.set_movement_workers(threads);
+        grid_sweep_ms(game);
+        settle(game);
+
+        double total = 0.0;
+        const int sweeps = 5;
+        for (int i = 0; i < sweeps; ++i) {
+            total += grid_sweep_ms(game);
+            settle(game);
+        }
+        double ms = total / sweeps;
+        if (threads == 1) baseline = ms;
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(16) << std::fixed << std::setprecision(2) << ms
+                  << std::setw(12) << baseline / ms << std::endl;
+    }
+
+    return 0;
+}
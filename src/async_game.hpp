@@ -4,289 +4,708 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
-#include <shared_mutex>
 #include <condition_variable>
 #include <vector>
-#include <queue>
+#include <fstream>
+#include <array>
 #include <random>
 #include <chrono>
 #include <iostream>
-#include <map>
 #include <algorithm>
 #include "async_npc.hpp"
+#include "world_store.hpp"
+#include "npc_types.hpp"
+#include "spatial_grid.hpp"
+#include "worker_pool.hpp"
+#include "mpmc_queue.hpp"
+#include "event_log.hpp"
+#include "counter_rng.hpp"
+#include "world_snapshot.hpp"
+#include "map_renderer.hpp"
+#include "world_file.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
 
 class AsyncGame {
+public:
+    enum class BattleResult { Skipped, Failed, Killed };
+    
 private:
-    std::vector<std::shared_ptr<AsyncNPC>> npcs;
-    mutable std::shared_mutex npcs_mutex;
+    WorldStore world;
+    
+    static constexpr size_t NPC_LOCK_STRIPES = 256;
     
-    std::queue<std::pair<std::shared_ptr<AsyncNPC>, std::shared_ptr<AsyncNPC>>> battle_queue;
-    std::mutex battle_mutex;
-    std::condition_variable battle_cv;
+    std::array<std::mutex, NPC_LOCK_STRIPES> npc_locks;
+    std::atomic<size_t> battles_resolved{0};
+    int battle_workers = 1;
     
-    std::queue<std::string> log_queue;
+    static constexpr size_t LOG_QUEUE_CAPACITY = 1 << 14;
+    static constexpr size_t LOG_BATCH_SIZE = 256;
+    
+    MPMCQueue<LogEvent> log_queue{LOG_QUEUE_CAPACITY};
     std::mutex log_mutex;
+    std::mutex log_drain_mutex;
+    std::mutex log_wake_mutex;
     std::condition_variable log_cv;
+    std::ofstream binary_log;
+    std::vector<LogEvent> log_batch;
+    std::string log_text;
+    std::chrono::steady_clock::time_point start_clock = std::chrono::steady_clock::now();
     
     std::atomic<bool> running{true};
     std::atomic<int> game_time{0};
+    std::atomic<uint64_t> tick_count{0};
+    bool console_log = true;
     
-    std::random_device rd;
-    std::mt19937 gen;
+    const uint64_t seed;
+    std::atomic<uint32_t> dice_draws{0};
     
-    const int MAP_WIDTH = 100;
-    const int MAP_HEIGHT = 100;
+    const int MAP_WIDTH;
+    const int MAP_HEIGHT;
     
-    struct NPCRules {
-        int move_distance;
-        int kill_distance;
-    };
+    SpatialGrid grid;
+    SnapshotPublisher snapshots;
     
-    std::map<std::string, NPCRules> rules = {
-        {"Rogue", {10, 10}},
-        {"Orc", {20, 10}},
-        {"Werewolf", {40, 5}},
-        {"Pegasus", {30, 10}}
+    static constexpr size_t DEATH_QUEUE_CAPACITY = 1 << 16;
+    static constexpr int MAP_DISPLAY_SIZE = 20;
+    
+    MapRenderer renderer;
+    std::mutex render_mutex;
+    MPMCQueue<uint32_t> death_queue{DEATH_QUEUE_CAPACITY};
+    std::atomic<bool> render_stale{true};
+    std::string map_text;
+    
+    std::unique_ptr<WorkerPool> movement_pool;
+    std::vector<std::vector<size_t>> strip_members;
+    std::vector<std::vector<size_t>> strip_cell_changes;
+    MapRenderer::Viewport sweep_view{};
+    uint64_t sweep_view_generation = 0;
+    std::vector<std::vector<std::pair<size_t, size_t>>> strip_battles;
+    std::vector<std::pair<size_t, size_t>> sweep_battles;
+    
+    struct Duel {
+        BattleResult result;
+        int attack_power;
+        int defense_power;
     };
     
-    void log_message(const std::string& message) {
-        std::lock_guard<std::mutex> lock(log_mutex);
-        log_queue.push(message);
+    static constexpr size_t BATTLES_PER_WORKER = 64;
+    
+    std::unique_ptr<WorkerPool> battle_pool;
+    std::vector<std::pair<size_t, size_t>> battle_batch;
+    std::vector<Duel> batch_duels;
+    std::vector<uint32_t> wave_of_npc;
+    std::vector<uint32_t> wave_of_battle;
+    std::vector<size_t> wave_start;
+    std::vector<size_t> wave_order;
+    
+    MetricsRegistry metrics;
+    Counter& sweeps = metrics.counter("async_sweeps_total", "Movement sweeps completed");
+    Counter& pairs_checked = metrics.counter("async_pairs_checked_total",
+                                             "Grid neighbours examined by kill checks");
+    Counter& log_events_written = metrics.counter("async_log_events_written_total",
+                                                  "Log events drained by the logger");
+    Histogram& sweep_latency = metrics.histogram("async_sweep_seconds", "Movement sweep latency");
+    Histogram& battle_latency = metrics.histogram("async_battle_seconds", "Single battle resolution latency");
+    Histogram& log_drain_latency = metrics.histogram("async_log_drain_seconds",
+                                                     "Logger drain latency for non-empty drains");
+    
+    void register_probes() {
+        using Type = MetricsRegistry::Type;
+        metrics.probe("async_sweep_battles", "Battles found by the last sweep and not yet fought",
+                      Type::Gauge, [this]() { return static_cast<double>(sweep_battles.size()); });
+        metrics.probe("async_log_queue_depth", "Log events waiting in the queue", Type::Gauge,
+                      [this]() { return static_cast<double>(log_queue.size()); });
+        metrics.probe("async_battles_resolved_total", "Battles fought to a result", Type::Counter,
+                      [this]() { return static_cast<double>(battles_resolved.load()); });
+        metrics.probe("async_tick", "Current simulation tick", Type::Gauge,
+                      [this]() { return static_cast<double>(tick_count.load()); });
+        metrics.probe("async_alive_npcs", "Alive NPCs in the latest snapshot", Type::Gauge,
+                      [this]() { return static_cast<double>(snapshots.acquire()->alive_count); });
+    }
+    
+    uint64_t log_timestamp() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_clock).count();
+    }
+    
+    // The snapshot goes out first so that a viewport change rebuilding from it
+    // in between is brought up to date by the touches that follow. That only
+    // holds if set_viewport() acquires the snapshot under render_mutex: one
+    // taken before the lock may predate touches already applied. Normally only
+    // the NPCs the sweep saw change display cell are touched; if the viewport
+    // changed since the sweep read it, those cells are stale and every mover is.
+    void publish_tick() {
+        TRACE_SPAN("publish_tick");
+        snapshots.publish(world, tick_count);
+        
+        auto lock = trace::acquire<std::lock_guard<std::mutex>>(render_mutex, "render_mutex");
+        if (render_stale.exchange(false)) {
+            uint32_t id;
+            while (death_queue.try_pop(id)) {}
+            renderer.rebuild(world);
+            return;
+        }
+        bool same_view = renderer.get_generation() == sweep_view_generation;
+        const auto& moved = same_view ? strip_cell_changes : strip_members;
+        for (const auto& members : moved) {
+            for (size_t id : members) renderer.touch(id, world);
+        }
+        uint32_t id;
+        while (death_queue.try_pop(id)) renderer.touch(id, world);
+    }
+    
+    // A full ring is drained on the producing thread instead of losing the
+    // event, so a tick with more battles than the ring holds only slows down.
+    void log_event(const LogEvent& event) {
+        while (!log_queue.try_push(event)) drain_log();
         log_cv.notify_one();
     }
     
 public:
-    AsyncGame() : gen(rd()) {
-        std::uniform_int_distribution<> type_dist(0, 3);
-        std::uniform_int_distribution<> coord_dist(0, MAP_WIDTH - 1);
-        
-        std::vector<std::string> types = {"Rogue", "Orc", "Werewolf", "Pegasus"};
-        
-        for (int i = 0; i < 50; ++i) {
-            int type_idx = type_dist(gen);
-            std::string type = types[type_idx];
-            std::string name = type + "_" + std::to_string(i);
-            int x = coord_dist(gen);
-            int y = coord_dist(gen);
-            
-            auto npc = std::make_shared<AsyncNPC>(name, x, y);
-            npc->type = type;
+    struct SpawnPoint {
+        NPCType type;
+        int x;
+        int y;
+    };
+    
+    static SpawnPoint spawn_point(uint64_t seed, uint32_t index, int width, int height) {
+        CounterRng rng(seed, CounterRng::Spawn, 0, index);
+        NPCType type = npc_type_at(rng.uniform(0, static_cast<int>(NPC_TYPE_COUNT) - 1));
+        int x = rng.uniform(0, width - 1);
+        int y = rng.uniform(0, height - 1);
+        return {type, x, y};
+    }
+    
+    AsyncGame(int npc_count = 50, int map_size = 100, uint64_t seed = std::random_device{}())
+        : seed(seed), MAP_WIDTH(map_size), MAP_HEIGHT(map_size),
+          grid(MAP_WIDTH, MAP_HEIGHT, npc_max_kill_distance()),
+          renderer(MapRenderer::fit(MAP_WIDTH, MAP_HEIGHT, MAP_DISPLAY_SIZE)) {
+        set_movement_workers(1);
+        set_battle_workers(1);
+        register_probes();
+        
+        world.reserve(npc_count);
+        
+        for (int i = 0; i < npc_count; ++i) {
+            SpawnPoint spawn = spawn_point(seed, static_cast<uint32_t>(i), MAP_WIDTH, MAP_HEIGHT);
+            std::string name = npc_type_name(spawn.type) + "_" + std::to_string(i);
             
-            std::lock_guard<std::shared_mutex> lock(npcs_mutex);
-            npcs.push_back(npc);
+            size_t id = world.add(name, spawn.type, spawn.x, spawn.y);
+            grid.insert(id, spawn.x, spawn.y);
         }
         
-        log_message("Game initialized with " + std::to_string(npcs.size()) + " NPCs");
+        publish_tick();
+        log_event(event_log::make_event(LogEventKind::GameInitialized, log_timestamp(),
+                                        static_cast<uint32_t>(world.size())));
     }
     
     int get_move_distance(const std::string& type) const {
-        auto it = rules.find(type);
-        return it != rules.end() ? it->second.move_distance : 0;
+        return npc_move_distance(parse_npc_type(type));
     }
     
     int get_kill_distance(const std::string& type) const {
-        auto it = rules.find(type);
-        return it != rules.end() ? it->second.kill_distance : 0;
+        return npc_kill_distance(parse_npc_type(type));
     }
     
-    bool can_kill(const std::string& attacker_type, const std::string& defender_type) {
-        if (attacker_type == "Rogue" && defender_type == "Werewolf") {
-            return true;
-        } else if (attacker_type == "Werewolf" && defender_type == "Rogue") {
-            return true;
-        } else if (attacker_type == "Orc" && defender_type == "Rogue") {
-            return true;
-        }
-        return false;
+    bool can_kill(const std::string& attacker_type, const std::string& defender_type) const {
+        return npc_can_kill(parse_npc_type(attacker_type), parse_npc_type(defender_type));
     }
     
     int roll_dice() {
-        std::uniform_int_distribution<> dist(1, 6);
-        return dist(gen);
+        CounterRng rng(seed, CounterRng::Dice, 0, dice_draws++);
+        return rng.uniform(1, 6);
     }
     
-    void movement_thread() {
-        std::uniform_int_distribution<> dir_dist(-1, 1);
-        std::uniform_int_distribution<> sleep_dist(10, 100);
+    uint64_t get_seed() const { return seed; }
+    
+    // Returns the number of grid neighbours examined.
+    size_t collect_targets(size_t id, std::vector<size_t>& targets) const {
+        int kill_dist = npc_kill_distance(world.type_id[id]);
+        int x = world.x[id];
+        int y = world.y[id];
+        size_t checked = 0;
         
-        while (running) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(sleep_dist(gen)));
+        grid.for_each_near(x, y, kill_dist, [&](size_t other_id) {
+            checked++;
+            if (other_id == id || !world.alive[other_id]) return;
+            int dx = x - world.x[other_id];
+            int dy = y - world.y[other_id];
+            if (std::sqrt(dx*dx + dy*dy) <= kill_dist) {
+                targets.push_back(other_id);
+            }
+        });
+        return checked;
+    }
+    
+    std::vector<size_t> find_targets(size_t id) const {
+        std::vector<size_t> targets;
+        collect_targets(id, targets);
+        std::sort(targets.begin(), targets.end());
+        return targets;
+    }
+    
+    void set_movement_workers(int count) {
+        size_t strips = static_cast<size_t>(std::max(1, count));
+        movement_pool = std::make_unique<WorkerPool>(strips);
+        
+        strip_members.assign(strips, {});
+        strip_cell_changes.assign(strips, {});
+        strip_battles.assign(strips, {});
+    }
+    
+    int get_movement_workers() const {
+        return static_cast<int>(movement_pool->size());
+    }
+    
+    // Each strip owns a band of grid rows. Ownership is fixed by position at the
+    // start of the sweep; NPCs that cross into another strip are rebucketed by
+    // the serial grid update before kill checks, which read the whole grid.
+    void movement_sweep() {
+        TRACE_SPAN("movement_sweep");
+        ScopedTimer timer(sweep_latency);
+        size_t strips = movement_pool->size();
+        int rows = grid.getRows();
+        auto strip_rows = [&](size_t strip, int& row_begin, int& row_end) {
+            row_begin = static_cast<int>(strip * rows / strips);
+            row_end = static_cast<int>((strip + 1) * rows / strips);
+        };
+        {
+            auto lock = trace::acquire<std::lock_guard<std::mutex>>(render_mutex, "render_mutex");
+            sweep_view = renderer.get_viewport();
+            sweep_view_generation = renderer.get_generation();
+        }
+        
+        movement_pool->run([&](size_t strip) {
+            TRACE_SPAN("move_strip");
+            auto& members = strip_members[strip];
+            auto& cell_changes = strip_cell_changes[strip];
+            uint64_t tick = tick_count;
+            int row_begin, row_end;
+            strip_rows(strip, row_begin, row_end);
             
-            std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
-            auto npcs_copy = npcs;
-            read_lock.unlock();
+            members.clear();
+            cell_changes.clear();
+            grid.for_each_in_rows(row_begin, row_end, [&](size_t id) {
+                if (world.alive[id] && npc_type_valid(world.type_id[id])) members.push_back(id);
+            });
+            std::sort(members.begin(), members.end());
             
-            for (auto& npc : npcs_copy) {
-                if (!npc->isAlive()) continue;
+            for (size_t id : members) {
+                int move_dist = npc_move_distance(world.type_id[id]);
                 
-                std::string type = npc->type;
-                if (rules.find(type) == rules.end()) continue;
+                CounterRng rng(seed, CounterRng::Movement, tick, static_cast<uint32_t>(id));
+                int dx = rng.uniform(-1, 1);
+                int dy = rng.uniform(-1, 1);
+                int new_x = world.x[id] + dx * move_dist;
+                int new_y = world.y[id] + dy * move_dist;
+                int32_t old_cell = MapRenderer::cell_of(sweep_view, world.x[id], world.y[id]);
                 
-                int move_dist = rules[type].move_distance;
-                int kill_dist = rules[type].kill_distance;
-                
-                int dx = dir_dist(gen);
-                int dy = dir_dist(gen);
-                int new_x = npc->getX() + dx * move_dist;
-                int new_y = npc->getY() + dy * move_dist;
-                
-                new_x = std::max(0, std::min(MAP_WIDTH - 1, new_x));
-                new_y = std::max(0, std::min(MAP_HEIGHT - 1, new_y));
-                
-                npc->setPosition(new_x, new_y);
+                world.x[id] = std::max(0, std::min(MAP_WIDTH - 1, new_x));
+                world.y[id] = std::max(0, std::min(MAP_HEIGHT - 1, new_y));
+                if (MapRenderer::cell_of(sweep_view, world.x[id], world.y[id]) != old_cell) {
+                    cell_changes.push_back(id);
+                }
+            }
+        });
+        
+        {
+            TRACE_SPAN("grid_update");
+            for (size_t strip = 0; strip < strips; ++strip) {
+                for (size_t id : strip_members[strip]) {
+                    grid.move(id, world.x[id], world.y[id]);
+                }
+            }
+        }
+        
+        movement_pool->run([&](size_t strip) {
+            TRACE_SPAN("kill_checks");
+            auto& battles = strip_battles[strip];
+            std::vector<size_t> targets;
+            size_t checked = 0;
+            battles.clear();
+            
+            for (size_t id : strip_members[strip]) {
+                NPCType type = world.type_id[id];
+                targets.clear();
+                checked += collect_targets(id, targets);
+                std::sort(targets.begin(), targets.end());
                 
-                for (auto& other : npcs_copy) {
-                    if (npc == other || !other->isAlive()) continue;
-                    
-                    double distance = npc->distanceTo(*other);
-                    if (distance <= kill_dist) {
-                        if (can_kill(type, other->type)) {
-                            std::lock_guard<std::mutex> lock(battle_mutex);
-                            battle_queue.push({npc, other});
-                            battle_cv.notify_one();
-                        }
+                for (size_t other_id : targets) {
+                    if (npc_can_kill(type, world.type_id[other_id])) {
+                        battles.push_back({id, other_id});
                     }
                 }
             }
+            pairs_checked.add(checked);
+        });
+        
+        TRACE_SPAN("collect_battles");
+        sweep_battles.clear();
+        for (const auto& battles : strip_battles) {
+            sweep_battles.insert(sweep_battles.end(), battles.begin(), battles.end());
         }
+        std::sort(sweep_battles.begin(), sweep_battles.end());
+        sweeps.add();
     }
     
-    void battle_thread() {
+    void movement_thread() {
+        TRACE_THREAD("movement");
         while (running) {
-            std::pair<std::shared_ptr<AsyncNPC>, std::shared_ptr<AsyncNPC>> battle;
-            
-            {
-                std::unique_lock<std::mutex> lock(battle_mutex);
-                battle_cv.wait(lock, [this]() { 
-                    return !battle_queue.empty() || !running; 
-                });
-                
-                if (!running && battle_queue.empty()) break;
-                
-                if (!battle_queue.empty()) {
-                    battle = battle_queue.front();
-                    battle_queue.pop();
-                } else {
-                    continue;
-                }
+            CounterRng jitter(seed, CounterRng::Jitter, tick_count, 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(jitter.uniform(10, 100)));
+            movement_sweep();
+            resolve_battle_batch();
+            tick_count++;
+            publish_tick();
+        }
+    }
+    
+    // The world is written by the simulation threads without a lock. Use these
+    // and the AsyncNPC views only while the game is stopped (before run() or
+    // between step() calls); read get_snapshot() while it runs.
+    size_t get_npc_count() const { return world.size(); }
+    
+    AsyncNPC get_npc(size_t id) { return AsyncNPC(world, id); }
+    
+    int get_grid_cell_size() const { return grid.getCellSize(); }
+    
+    void set_battle_workers(int count) {
+        battle_workers = std::max(1, count);
+        battle_pool = std::make_unique<WorkerPool>(static_cast<size_t>(battle_workers));
+    }
+    
+    int get_battle_workers() const { return battle_workers; }
+    size_t get_sweep_battles() const { return sweep_battles.size(); }
+    
+    // Both NPCs are locked (lower stripe first) so that a concurrent resolver
+    // cannot kill the attacker or the defender between the check and the kill.
+    BattleResult resolve_battle(size_t attacker, size_t defender, int attack_power, int defense_power) {
+        size_t first = std::min(attacker % NPC_LOCK_STRIPES, defender % NPC_LOCK_STRIPES);
+        size_t second = std::max(attacker % NPC_LOCK_STRIPES, defender % NPC_LOCK_STRIPES);
+        
+        auto first_lock = trace::acquire<std::unique_lock<std::mutex>>(npc_locks[first], "npc_lock");
+        std::unique_lock<std::mutex> second_lock;
+        if (second != first) {
+            second_lock = trace::acquire<std::unique_lock<std::mutex>>(npc_locks[second], "npc_lock");
+        }
+        
+        if (!world.alive[attacker] || !world.alive[defender]) return BattleResult::Skipped;
+        if (attack_power <= defense_power) return BattleResult::Failed;
+        if (!world.alive[defender].kill()) return BattleResult::Skipped;
+        if (!death_queue.try_push(static_cast<uint32_t>(defender))) render_stale = true;
+        return BattleResult::Killed;
+    }
+    
+    Duel duel(size_t attacker, size_t defender) {
+        if (!world.alive[attacker] || !world.alive[defender]) return {BattleResult::Skipped, 0, 0};
+        TRACE_SPAN("fight");
+        ScopedTimer timer(battle_latency);
+        
+        CounterRng rng(seed, CounterRng::Battle, tick_count,
+                       static_cast<uint32_t>(attacker), static_cast<uint32_t>(defender));
+        int attack_power = rng.uniform(1, 6);
+        int defense_power = rng.uniform(1, 6);
+        return {resolve_battle(attacker, defender, attack_power, defense_power), attack_power, defense_power};
+    }
+    
+    void record_duel(size_t attacker, size_t defender, const Duel& outcome) {
+        if (outcome.result == BattleResult::Skipped) return;
+        battles_resolved++;
+        LogEventKind kind = outcome.result == BattleResult::Killed ? LogEventKind::Kill : LogEventKind::FailedKill;
+        log_event(event_log::make_battle_event(kind, log_timestamp(), attacker, defender,
+                                               outcome.attack_power, outcome.defense_power));
+    }
+    
+    BattleResult fight(size_t attacker, size_t defender) {
+        Duel outcome = duel(attacker, defender);
+        record_duel(attacker, defender, outcome);
+        return outcome.result;
+    }
+    
+    // Fights every battle found by the last sweep as if one at a time in sorted
+    // order, but in parallel waves. A battle's wave is one past the latest
+    // earlier battle sharing an NPC with it, so battles within a wave touch
+    // disjoint NPCs and every conflicting pair keeps its order. Outcomes and the
+    // log are therefore the same for any number of battle workers.
+    size_t resolve_battle_batch() {
+        TRACE_SPAN("resolve_battles");
+        battle_batch.swap(sweep_battles);
+        sweep_battles.clear();
+        size_t count = battle_batch.size();
+        if (count == 0) return 0;
+        
+        if (wave_of_npc.size() < world.size()) wave_of_npc.resize(world.size(), 0);
+        wave_of_battle.resize(count);
+        uint32_t waves = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t& first = wave_of_npc[battle_batch[i].first];
+            uint32_t& second = wave_of_npc[battle_batch[i].second];
+            uint32_t wave = std::max(first, second);
+            first = second = wave + 1;
+            wave_of_battle[i] = wave;
+            waves = std::max(waves, wave + 1);
+        }
+        for (const auto& pair : battle_batch) {
+            wave_of_npc[pair.first] = 0;
+            wave_of_npc[pair.second] = 0;
+        }
+        
+        wave_start.assign(waves + 1, 0);
+        for (uint32_t wave : wave_of_battle) wave_start[wave + 1]++;
+        for (uint32_t w = 0; w < waves; ++w) wave_start[w + 1] += wave_start[w];
+        wave_order.resize(count);
+        {
+            std::vector<size_t> next(wave_start.begin(), wave_start.end() - 1);
+            for (size_t i = 0; i < count; ++i) wave_order[next[wave_of_battle[i]]++] = i;
+        }
+        
+        batch_duels.resize(count);
+        auto fight_range = [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                size_t i = wave_order[k];
+                batch_duels[i] = duel(battle_batch[i].first, battle_batch[i].second);
             }
+        };
+        size_t workers = battle_pool->size();
+        for (uint32_t w = 0; w < waves; ++w) {
+            size_t begin = wave_start[w];
+            size_t size = wave_start[w + 1] - begin;
+            size_t chunks = std::min(workers, size / BATTLES_PER_WORKER);
+            if (chunks <= 1) {
+                fight_range(begin, begin + size);
+                continue;
+            }
+            battle_pool->run([&](size_t chunk) {
+                if (chunk >= chunks) return;
+                fight_range(begin + chunk * size / chunks, begin + (chunk + 1) * size / chunks);
+            });
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            record_duel(battle_batch[i].first, battle_batch[i].second, batch_duels[i]);
+        }
+        return count;
+    }
+    
+    bool set_binary_log(const std::string& filename) {
+        binary_log.open(filename, std::ios::binary | std::ios::trunc);
+        return binary_log.is_open() && event_log::write_binary_header(binary_log);
+    }
+    
+    // Serialised so that the logger thread and a producer draining a full ring
+    // write batches whole and in queue order.
+    size_t drain_log() {
+        TRACE_SPAN("drain_log");
+        auto drain_lock = trace::acquire<std::lock_guard<std::mutex>>(log_drain_mutex, "log_drain_mutex");
+        auto start = std::chrono::steady_clock::now();
+        size_t written = 0;
+        LogEvent event;
+        
+        while (true) {
+            log_batch.clear();
+            while (log_batch.size() < LOG_BATCH_SIZE && log_queue.try_pop(event)) {
+                log_batch.push_back(event);
+            }
+            if (log_batch.empty()) break;
             
-            auto& attacker = battle.first;
-            auto& defender = battle.second;
-            
-            if (!attacker->isAlive() || !defender->isAlive()) continue;
-            
-            int attack_power = roll_dice();
-            int defense_power = roll_dice();
-            
-            {
-                std::lock_guard<std::mutex> cout_lock(log_mutex);
-                if (attack_power > defense_power) {
-                    defender->die();
-                    log_message(attacker->type + " " + attacker->getName() + 
-                               " killed " + defender->type + " " + defender->getName() +
-                               " (" + std::to_string(attack_power) + " vs " + 
-                               std::to_string(defense_power) + ")");
-                } else {
-                    log_message(attacker->type + " " + attacker->getName() + 
-                               " failed to kill " + defender->type + " " + defender->getName() +
-                               " (" + std::to_string(attack_power) + " vs " + 
-                               std::to_string(defense_power) + ")");
+            if (console_log) {
+                log_text.clear();
+                for (const auto& queued : log_batch) {
+                    event_log::format(log_text, queued, &world);
                 }
+                
+                auto cout_lock = trace::acquire<std::lock_guard<std::mutex>>(log_mutex, "log_mutex");
+                std::cout.write(log_text.data(), static_cast<std::streamsize>(log_text.size()));
             }
+            if (binary_log.is_open()) {
+                event_log::write_binary(binary_log, log_batch.data(), log_batch.size());
+            }
+            written += log_batch.size();
         }
+        
+        if (written > 0) {
+            log_events_written.add(written);
+            log_drain_latency.observe(metrics::elapsed_ns(start));
+        }
+        return written;
     }
     
     void logger_thread() {
+        TRACE_THREAD("logger");
         while (running) {
-            std::string message;
+            if (drain_log() > 0) continue;
             
             {
-                std::unique_lock<std::mutex> lock(log_mutex);
-                log_cv.wait_for(lock, std::chrono::milliseconds(100), 
-                              [this]() { return !log_queue.empty() || !running; });
-                
-                if (!running && log_queue.empty()) break;
-                
-                if (!log_queue.empty()) {
-                    message = log_queue.front();
-                    log_queue.pop();
-                } else {
-                    continue;
-                }
+                auto cout_lock = trace::acquire<std::lock_guard<std::mutex>>(log_mutex, "log_mutex");
+                std::cout.flush();
             }
+            if (binary_log.is_open()) binary_log.flush();
             
-            std::lock_guard<std::mutex> cout_lock(log_mutex);
-            std::cout << "[LOG] " << message << std::endl;
+            auto lock = trace::acquire<std::unique_lock<std::mutex>>(log_wake_mutex, "log_wake_mutex");
+            log_cv.wait_for(lock, std::chrono::milliseconds(100), 
+                          [this]() { return !log_queue.empty() || !running; });
         }
+        
+        drain_log();
+        auto cout_lock = trace::acquire<std::lock_guard<std::mutex>>(log_mutex, "log_mutex");
+        std::cout.flush();
+        if (binary_log.is_open()) binary_log.flush();
     }
     
-    void print_map() {
-        std::lock_guard<std::mutex> cout_lock(log_mutex);
+    MetricsRegistry& get_metrics() { return metrics; }
+    const MetricsRegistry& get_metrics() const { return metrics; }
+    
+    std::shared_ptr<const WorldSnapshot> get_snapshot() const {
+        return snapshots.acquire();
+    }
+    
+    // Replaces the world with a mapped world file. The columns are bulk-copied
+    // because the simulation mutates them; call before run(). Snapshots taken
+    // earlier keep the name list they were published with.
+    bool load_world(const std::string& filename, std::string& error) {
+        WorldFile file;
+        if (!file.open(filename, error)) return false;
         
-        std::cout << "\n=== Game Time: " << game_time << "s ===" << std::endl;
-        std::cout << "Map (" << MAP_WIDTH << "x" << MAP_HEIGHT << "):\n";
+        std::vector<NPCType> types(file.type_count());
+        for (size_t code = 0; code < types.size(); ++code) {
+            types[code] = parse_npc_type(std::string(file.type_name(code)));
+        }
         
-        std::vector<std::vector<char>> map(MAP_HEIGHT, std::vector<char>(MAP_WIDTH, '.'));
+        size_t count = file.size();
+        world.clear();
+        world.x.assign(file.xs(), file.xs() + count);
+        world.y.assign(file.ys(), file.ys() + count);
+        world.alive.assign(file.alive(), file.alive() + count);
+        world.type_id.resize(count);
+        std::vector<std::string>& names = world.own_names();
+        names.reserve(count);
         
-        std::shared_lock<std::shared_mutex> lock(npcs_mutex);
-        for (const auto& npc : npcs) {
-            if (!npc->isAlive()) continue;
-            
-            int x = npc->getX();
-            int y = npc->getY();
-            
-            if (x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT) {
-                char symbol = '.';
-                if (npc->type == "Rogue") symbol = 'R';
-                else if (npc->type == "Orc") symbol = 'O';
-                else if (npc->type == "Werewolf") symbol = 'W';
-                else if (npc->type == "Pegasus") symbol = 'P';
-                
-                map[y][x] = symbol;
-            }
+        grid.clear();
+        for (size_t id = 0; id < count; ++id) {
+            world.x[id] = std::max(0, std::min(MAP_WIDTH - 1, world.x[id]));
+            world.y[id] = std::max(0, std::min(MAP_HEIGHT - 1, world.y[id]));
+            world.type_id[id] = types[file.types()[id]];
+            names.emplace_back(file.name(id));
+            grid.insert(id, world.x[id], world.y[id]);
         }
-        lock.unlock();
-        
-        int display_size = 20;
-        for (int y = 0; y < display_size; ++y) {
-            for (int x = 0; x < display_size; ++x) {
-                int map_x = x * MAP_WIDTH / display_size;
-                int map_y = y * MAP_HEIGHT / display_size;
-                std::cout << map[map_y][map_x];
-            }
-            std::cout << std::endl;
+        
+        sweep_battles.clear();
+        for (auto& members : strip_members) members.clear();
+        for (auto& changes : strip_cell_changes) changes.clear();
+        render_stale = true;
+        publish_tick();
+        return true;
+    }
+    
+    bool save_world(const std::string& filename) const {
+        auto view = snapshots.acquire();
+        WorldFileWriter writer;
+        writer.reserve(view->size());
+        for (size_t id = 0; id < view->size(); ++id) {
+            writer.add(npc_type_name(view->type_id[id]), view->name(id),
+                       view->x[id], view->y[id], view->alive[id] != 0);
         }
+        return writer.save(filename);
+    }
+    
+    void set_viewport(const MapRenderer::Viewport& viewport) {
+        auto lock = trace::acquire<std::lock_guard<std::mutex>>(render_mutex, "render_mutex");
+        auto view = snapshots.acquire();
+        renderer.set_viewport(viewport);
+        renderer.rebuild(*view);
+    }
+    
+    MapRenderer::Viewport get_viewport() {
+        auto lock = trace::acquire<std::lock_guard<std::mutex>>(render_mutex, "render_mutex");
+        return renderer.get_viewport();
+    }
+    
+    char get_map_glyph(int col, int row) {
+        auto lock = trace::acquire<std::lock_guard<std::mutex>>(render_mutex, "render_mutex");
+        return renderer.glyph(col, row);
+    }
+    
+    // The frame is assembled in a reused buffer and written with one call.
+    void print_map() {
+        TRACE_SPAN("print_map");
+        auto view = snapshots.acquire();
+        auto render_lock = trace::acquire<std::lock_guard<std::mutex>>(render_mutex, "render_mutex");
+        const auto& viewport = renderer.get_viewport();
         
-        int alive = 0;
-        int rogues = 0, orcs = 0, werewolves = 0, pegasus = 0;
-        
-        lock.lock();
-        for (const auto& npc : npcs) {
-            if (npc->isAlive()) {
-                alive++;
-                if (npc->type == "Rogue") rogues++;
-                else if (npc->type == "Orc") orcs++;
-                else if (npc->type == "Werewolf") werewolves++;
-                else if (npc->type == "Pegasus") pegasus++;
-            }
+        map_text.clear();
+        map_text += "\n=== Game Time: ";
+        MapRenderer::append_number(map_text, game_time);
+        map_text += "s ===\nMap (";
+        MapRenderer::append_number(map_text, MAP_WIDTH);
+        map_text += 'x';
+        MapRenderer::append_number(map_text, MAP_HEIGHT);
+        map_text += ", zoom ";
+        MapRenderer::append_number(map_text, viewport.zoom);
+        map_text += "):\n";
+        renderer.compose(map_text);
+        
+        map_text += "\nStatistics:\nAlive: ";
+        MapRenderer::append_number(map_text, static_cast<long long>(view->alive_count));
+        map_text += '/';
+        MapRenderer::append_number(map_text, static_cast<long long>(view->size()));
+        map_text += '\n';
+        for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) {
+            map_text += NPC_TYPE_INFO[i].plural;
+            map_text += ": ";
+            MapRenderer::append_number(map_text, static_cast<long long>(view->type_counts[i]));
+            map_text += '\n';
+        }
+        map_text += "=========================\n\n";
+        
+        auto cout_lock = trace::acquire<std::lock_guard<std::mutex>>(log_mutex, "log_mutex");
+        std::cout.write(map_text.data(), static_cast<std::streamsize>(map_text.size()));
+        std::cout.flush();
+    }
+    
+    struct HeadlessStats {
+        uint64_t ticks;
+        double seconds;
+        double ticks_per_second;
+        size_t battles_resolved;
+        size_t survivors;
+    };
+    
+    void set_console_log(bool enabled) { console_log = enabled; }
+    uint64_t get_tick() const { return tick_count; }
+    size_t get_battles_resolved() const { return battles_resolved; }
+    
+    size_t get_alive_count() const {
+        return snapshots.acquire()->alive_count;
+    }
+    
+    void step() {
+        TRACE_SPAN("step");
+        movement_sweep();
+        resolve_battle_batch();
+        drain_log();
+        tick_count++;
+        publish_tick();
+    }
+    
+    HeadlessStats run_headless(uint64_t ticks) {
+        auto start = std::chrono::steady_clock::now();
+        size_t resolved_before = battles_resolved;
+        
+        for (uint64_t i = 0; i < ticks; ++i) {
+            step();
         }
-        lock.unlock();
         
-        std::cout << "\nStatistics:" << std::endl;
-        std::cout << "Alive: " << alive << "/" << npcs.size() << std::endl;
-        std::cout << "Rogues: " << rogues << std::endl;
-        std::cout << "Orcs: " << orcs << std::endl;
-        std::cout << "Werewolves: " << werewolves << std::endl;
-        std::cout << "Pegasus: " << pegasus << std::endl;
-        std::cout << "=========================\n" << std::endl;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {ticks, seconds, seconds > 0 ? ticks / seconds : 0.0,
+                battles_resolved - resolved_before, get_alive_count()};
     }
     
     void run() {
-        log_message("Starting async game...");
+        TRACE_THREAD("render");
+        log_event(event_log::make_event(LogEventKind::GameStarted, log_timestamp()));
         
         std::thread movement(&AsyncGame::movement_thread, this);
-        std::thread battle(&AsyncGame::battle_thread, this);
         std::thread logger(&AsyncGame::logger_thread, this);
         
         auto start_time = std::chrono::steady_clock::now();
@@ -302,41 +721,33 @@ public:
         }
         
         running = false;
-        
-        battle_cv.notify_all();
         log_cv.notify_all();
         
         if (movement.joinable()) movement.join();
-        if (battle.joinable()) battle.join();
         if (logger.joinable()) logger.join();
         
-        std::lock_guard<std::mutex> cout_lock(log_mutex);
+        publish_tick();
+        auto view = snapshots.acquire();
+        
+        auto cout_lock = trace::acquire<std::lock_guard<std::mutex>>(log_mutex, "log_mutex");
         std::cout << "\n=== GAME OVER ===" << std::endl;
         std::cout << "Final survivors:" << std::endl;
         
-        std::shared_lock<std::shared_mutex> lock(npcs_mutex);
-        for (const auto& npc : npcs) {
-            if (npc->isAlive()) {
-                std::cout << "  " << npc->type << " '" << npc->getName() 
-                          << "' at (" << npc->getX() << ", " << npc->getY() << ")" << std::endl;
-            }
-        }
-        
-        int survivors = 0;
-        for (const auto& npc : npcs) {
-            if (npc->isAlive()) {
-                survivors++;
+        for (size_t id = 0; id < view->size(); ++id) {
+            if (view->alive[id]) {
+                std::cout << "  " << npc_type_name(view->type_id[id]) << " '" << view->name(id) 
+                          << "' at (" << view->x[id] << ", " << view->y[id] << ")" << std::endl;
             }
         }
         
         std::cout << "\nTotal survivors: " 
-                  << survivors
-                  << " out of " << npcs.size() << std::endl;
+                  << view->alive_count
+                  << " out of " << view->size() << std::endl;
+        std::cout << "Battles resolved: " << battles_resolved << std::endl;
     }
     
     ~AsyncGame() {
         running = false;
-        battle_cv.notify_all();
         log_cv.notify_all();
     }
 };
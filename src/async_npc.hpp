@@ -5,75 +5,104 @@
 #include <string>
 #include <memory>
 #include <cmath>
+#include <stdexcept>
+#include "world_store.hpp"
 
 class AsyncNPC {
 protected:
-    std::string name;
-    int x;
-    int y;
-    bool alive;
-    
+    std::shared_ptr<WorldStore> owned;
+    WorldStore* store;
+    size_t slot;
+
 public:
-    std::string type;
-    
-    AsyncNPC(const std::string& name, int x, int y) 
-        : name(name), x(x), y(y), alive(true), type("") {
+    class TypeField {
+    private:
+        WorldStore* store;
+        size_t slot;
+
+    public:
+        TypeField(WorldStore* store, size_t slot) : store(store), slot(slot) {}
+
+        TypeField& operator=(const std::string& value) {
+            store->type_id[slot] = parse_npc_type(value);
+            return *this;
+        }
+
+        operator const std::string&() const { return store->type_name(slot); }
+        const std::string& str() const { return store->type_name(slot); }
+    };
+
+    TypeField type;
+
+    AsyncNPC(const std::string& name, int x, int y)
+        : owned(std::make_shared<WorldStore>()), store(owned.get()), slot(0), type(store, 0) {
         if (x < 0 || x > 500 || y < 0 || y > 500) {
             throw std::invalid_argument("Coordinates must be between 0 and 500");
         }
+        store->add(name, NPCType::None, x, y);
     }
-    
+
+    AsyncNPC(WorldStore& world, size_t slot)
+        : store(&world), slot(slot), type(store, slot) {}
+
+    AsyncNPC(const AsyncNPC& other)
+        : owned(other.owned), store(other.store), slot(other.slot), type(store, slot) {}
+
+    AsyncNPC& operator=(const AsyncNPC&) = delete;
+
     virtual ~AsyncNPC() = default;
-    
-    std::string getType() const { return type; }
-    
+
+    size_t getSlot() const { return slot; }
+    std::string getType() const { return store->type_name(slot); }
+    NPCType getTypeId() const { return store->type_id[slot]; }
+
     void print() const {
-        std::cout << type << " '" << name 
-                  << "' at (" << x << ", " << y 
-                  << ") - " << (alive ? "Alive" : "Dead") << std::endl;
+        std::cout << getType() << " '" << getName()
+                  << "' at (" << getX() << ", " << getY()
+                  << ") - " << (isAlive() ? "Alive" : "Dead") << std::endl;
     }
-    
-    const std::string& getName() const { return name; }
-    int getX() const { return x; }
-    int getY() const { return y; }
-    bool isAlive() const { return alive; }
-    
+
+    const std::string& getName() const { return store->name(slot); }
+    int getX() const { return store->x[slot]; }
+    int getY() const { return store->y[slot]; }
+    bool isAlive() const { return store->alive[slot] != 0; }
+
     void setPosition(int newX, int newY) {
         if (newX >= 0 && newX <= 500 && newY >= 0 && newY <= 500) {
-            x = newX;
-            y = newY;
+            store->x[slot] = newX;
+            store->y[slot] = newY;
         }
     }
-    void die() { alive = false; }
-    
+    void die() { store->alive[slot] = 0; }
+
     double distanceTo(const AsyncNPC& other) const {
-        int dx = x - other.x;
-        int dy = y - other.y;
+        int dx = getX() - other.getX();
+        int dy = getY() - other.getY();
         return std::sqrt(dx*dx + dy*dy);
     }
-    
+
     std::string save() const {
-        return type + "," + name + "," + std::to_string(x) + "," + 
-               std::to_string(y) + "," + (alive ? "1" : "0");
+        return getType() + "," + getName() + "," + std::to_string(getX()) + "," +
+               std::to_string(getY()) + "," + (isAlive() ? "1" : "0");
     }
-    
+
     static std::shared_ptr<AsyncNPC> load(const std::string& data) {
         size_t pos1 = data.find(',');
         size_t pos2 = data.find(',', pos1 + 1);
         size_t pos3 = data.find(',', pos2 + 1);
         size_t pos4 = data.find(',', pos3 + 1);
-        
-        if (pos1 == std::string::npos || pos2 == std::string::npos || 
+
+        if (pos1 == std::string::npos || pos2 == std::string::npos ||
             pos3 == std::string::npos || pos4 == std::string::npos) {
             return nullptr;
         }
-        
+
         std::string type = data.substr(0, pos1);
         std::string name = data.substr(pos1 + 1, pos2 - pos1 - 1);
         int x = std::stoi(data.substr(pos2 + 1, pos3 - pos2 - 1));
         int y = std::stoi(data.substr(pos3 + 1, pos4 - pos3 - 1));
         bool alive = data.substr(pos4 + 1) == "1";
-        
+
         auto npc = std::make_shared<AsyncNPC>(name, x, y);
         npc->type = type;
         if (!alive) {
@@ -83,4 +112,4 @@ public:
     }
 };
 
-#endif
\ No newline at end of file
+#endif
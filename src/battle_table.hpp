@@ -0,0 +1,27 @@
+#ifndef BATTLE_TABLE_HPP
+#define BATTLE_TABLE_HPP
+
+#include "npc.hpp"
+
+enum class BattleOutcome : uint8_t {
+    None,
+    DefenderDies
+};
+
+// Rows are attackers, columns are defenders, both indexed by NPCKind.
+constexpr BattleOutcome BATTLE_TABLE[NPC_KIND_COUNT][NPC_KIND_COUNT] = {
+    //              Rogue                        Orc                  Werewolf
+    /* Rogue */    {BattleOutcome::None,         BattleOutcome::None, BattleOutcome::DefenderDies},
+    /* Orc */      {BattleOutcome::DefenderDies, BattleOutcome::None, BattleOutcome::None},
+    /* Werewolf */ {BattleOutcome::DefenderDies, BattleOutcome::None, BattleOutcome::None},
+};
+
+constexpr BattleOutcome battleOutcome(NPCKind attacker, NPCKind defender) {
+    return BATTLE_TABLE[static_cast<size_t>(attacker)][static_cast<size_t>(defender)];
+}
+
+constexpr bool canDefeat(NPCKind attacker, NPCKind defender) {
+    return battleOutcome(attacker, defender) == BattleOutcome::DefenderDies;
+}
+
+#endif
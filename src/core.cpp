@@ -1,47 +1,183 @@
 #include "core.hpp"
 
-Core::Core() {
-    attach(new ConsoleObserver());
-    attach(new FileObserver("log.txt"));
+Core::Core() 
+    : pool(new NPCPool()),
+      consoleObserver(new ConsoleObserver()), 
+      fileObserver(new FileObserver("log.txt")),
+      consoleOutput(true), fileOutput(true),
+      battleRuns(metrics.counter("core_battle_simulations_total", "simulateBattle calls")),
+      battleCandidates(metrics.counter("core_battle_candidates_total",
+                                       "In-range pairs that can end in a kill")),
+      battleKills(metrics.counter("core_battle_kills_total", "NPCs killed in simulated battles")),
+      battleLatency(metrics.histogram("core_battle_simulation_seconds", "simulateBattle latency")) {
+    attach(consoleObserver.get());
+    attach(fileObserver.get());
 }
 
 Core::~Core() {
+    setAsync(false);
+    closeJournal();
+    detach(consoleObserver.get());
+    detach(fileObserver.get());
 }
 
-bool Core::isNameUnique(const std::string& name) const {
-    for (const auto& npc : npcs) {
-        if (npc->getName() == name) {
-            return false;
-        }
+void Core::setConsoleOutput(bool enabled) {
+    if (enabled == consoleOutput) return;
+    if (enabled) attach(consoleObserver.get());
+    else detach(consoleObserver.get());
+    consoleOutput = enabled;
+}
+
+void Core::setFileOutput(bool enabled) {
+    if (enabled == fileOutput) return;
+    if (enabled) attach(fileObserver.get());
+    else detach(fileObserver.get());
+    fileOutput = enabled;
+}
+
+void Core::setConsoleLevel(EventLevel level) {
+    consoleObserver->setMinLevel(level);
+}
+
+void Core::setFileLevel(EventLevel level) {
+    fileObserver->setMinLevel(level);
+}
+
+static Event counted(EventKind kind, size_t count, const std::string& source = std::string()) {
+    Event event{kind};
+    event.count = count;
+    event.source = source;
+    return event;
+}
+
+// Failures are rare, so their text is built up front.
+void Core::fail(std::string message) {
+    if (!wants(EventKind::Failure)) return;
+    Event event{EventKind::Failure};
+    event.text = std::move(message);
+    notify(std::move(event));
+}
+
+bool Core::isNameUnique(std::string_view name) const {
+    return nameIndex.find(name) == NameIndex::npos;
+}
+
+void Core::rebuildIndex() {
+    nameIndex.clear();
+    nameIndex.reserve(npcs.size());
+    for (size_t i = 0; i < npcs.size(); i++) {
+        nameIndex.insert(npcs[i]->getName(), i);
     }
-    return true;
+}
+
+// Replaces the world; the old NPCs go first, then the pool they were built in.
+// `index` must already map every loaded name to its slot.
+void Core::adopt(std::vector<std::shared_ptr<NPC>>& loaded, std::unique_ptr<NPCPool> loadedPool, NameIndex& index) {
+    npcs = std::move(loaded);
+    pool = std::move(loadedPool);
+    std::swap(nameIndex, index);
+}
+
+std::shared_ptr<const NPC> Core::findNPC(std::string_view name) const {
+    size_t slot = nameIndex.find(name);
+    return slot == NameIndex::npos ? nullptr : npcs[slot];
 }
 
 bool Core::addNPC(const std::string& type, const std::string& name, int x, int y) {
     try {
         if (!isNameUnique(name)) {
-            notify("Failed to add NPC: name '" + name + "' is already taken");
+            fail("Failed to add NPC: name '" + name + "' is already taken");
             return false;
         }
         
-        auto npc = NPCFactory::createNPC(type, name, x, y);
+        NPCKind kind;
+        if (!NPCFactory::kindFromName(type, kind)) {
+            throw std::invalid_argument("Unknown NPC type: " + type);
+        }
+        
+        auto npc = NPCFactory::createNPC(kind, *pool, name, x, y);
+        nameIndex.insert(npc->getName(), npcs.size());
         npcs.push_back(npc);
+        if (journal) {
+            journal->append(JournalOp::Add, npc->getKind(), name, x, y);
+            journalCommit();
+        }
         
-        std::string message = "Added " + type + " '" + name + 
-                             "' at (" + std::to_string(x) + ", " + 
-                             std::to_string(y) + ")";
-        notify(message);
+        if (wants(EventKind::NPCAdded)) notify({EventKind::NPCAdded, npc, nullptr, x, y});
         return true;
     } catch (const std::exception& e) {
-        notify("Failed to add NPC: " + std::string(e.what()));
+        fail("Failed to add NPC: " + std::string(e.what()));
         return false;
     }
 }
 
+// All-or-nothing: every entry is checked (type, coordinates, names against
+// the world and the rest of the batch) before anything is added.
+bool Core::addNPCs(const std::vector<NPCSpec>& batch) {
+    std::vector<NPCKind> kinds(batch.size());
+    std::unordered_map<std::string_view, size_t> batchNames;
+    batchNames.reserve(batch.size());
+    std::vector<std::string> errors;
+    
+    for (size_t i = 0; i < batch.size(); i++) {
+        const NPCSpec& spec = batch[i];
+        std::string problem;
+        if (!NPCFactory::kindFromName(spec.type, kinds[i])) {
+            problem = "unknown type '" + std::string(spec.type) + "'";
+        } else if (spec.x < NPC::MIN_COORD || spec.x > NPC::MAX_COORD ||
+                   spec.y < NPC::MIN_COORD || spec.y > NPC::MAX_COORD) {
+            problem = "coordinates out of range";
+        } else if (!isNameUnique(spec.name)) {
+            problem = "name '" + std::string(spec.name) + "' is already taken";
+        } else if (!batchNames.emplace(spec.name, i).second) {
+            problem = "name '" + std::string(spec.name) + "' repeats entry " +
+                      std::to_string(batchNames[spec.name]);
+        }
+        if (!problem.empty()) errors.push_back("entry " + std::to_string(i) + ": " + problem);
+    }
+    
+    if (!errors.empty()) {
+        const size_t reportLimit = 10;
+        for (size_t i = 0; i < errors.size() && i < reportLimit; i++) {
+            fail("Failed to add NPC batch: " + errors[i]);
+        }
+        fail("Rejected batch of " + std::to_string(batch.size()) + " NPCs (" +
+             std::to_string(errors.size()) + " invalid entries)");
+        return false;
+    }
+    
+    size_t first = npcs.size();
+    std::vector<NPCSeed> seeds(batch.size());
+    nameIndex.reserve(first + batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        const NPCSpec& spec = batch[i];
+        seeds[i] = {kinds[i], &pool->getNames().store(spec.name), spec.x, spec.y, true};
+        nameIndex.insert(*seeds[i].name, first + i);
+    }
+    npcs.resize(first + batch.size());
+    pool->createBatch(seeds.data(), seeds.size(), npcs.data() + first);
+    
+    if (journal) {
+        for (const auto& seed : seeds) journal->append(JournalOp::Add, seed.kind, *seed.name, seed.x, seed.y);
+        journalCommit();
+    }
+    
+    if (wants(EventKind::BatchAdded)) notify({EventKind::BatchAdded, nullptr, nullptr, 0, 0, batch.size()});
+    return true;
+}
+
+static bool isWorldFileName(const std::string& filename) {
+    static const std::string extension = ".bfw";
+    return filename.size() > extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
 bool Core::saveToFile(const std::string& filename) {
+    if (isWorldFileName(filename)) return saveSnapshot(filename);
+    
     std::ofstream file(filename);
     if (!file.is_open()) {
-        notify("Failed to open file for writing: " + filename);
+        fail("Failed to open file for writing: " + filename);
         return false;
     }
     
@@ -54,34 +190,276 @@ bool Core::saveToFile(const std::string& filename) {
     }
     
     file.close();
-    notify("Saved " + std::to_string(aliveCount) + " NPCs to " + filename);
+    if (wants(EventKind::Saved)) notify(counted(EventKind::Saved, aliveCount, filename));
     return true;
 }
 
 bool Core::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
+    if (world_file::has_magic(filename)) return loadSnapshot(filename);
+    
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
-        notify("Failed to open file for reading: " + filename);
+        fail("Failed to open file for reading: " + filename);
         return false;
     }
     
-    npcs.clear();
-    std::string line;
-    int count = 0;
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&text[0], static_cast<std::streamsize>(text.size()));
+    file.close();
     
-    while (std::getline(file, line)) {
-        auto npc = NPC::load(line);
-        if (npc) {
-            npcs.push_back(npc);
-            count++;
+    CsvLoader loader;
+    std::vector<CsvRecord> records;
+    loader.parse(text, records, loadErrors);
+    
+    // Names and coordinates are checked serially, which fixes every accepted
+    // record's final slot and fills the name index in the same pass; the NPCs
+    // are then built in parallel straight into those slots, each worker
+    // carving its own slabs over the shared name arena.
+    auto loadedPool = std::make_unique<NPCPool>();
+    NameIndex index;
+    index.reserve(records.size());
+    std::vector<NPCSeed> seeds;
+    seeds.reserve(records.size());
+    for (const CsvRecord& record : records) {
+        if (record.x < NPC::MIN_COORD || record.x > NPC::MAX_COORD ||
+            record.y < NPC::MIN_COORD || record.y > NPC::MAX_COORD) {
+            loadErrors.push_back({record.line, "coordinates out of range"});
+        } else if (index.find(record.name) != NameIndex::npos) {
+            loadErrors.push_back({record.line, "duplicate name '" + std::string(record.name) + "'"});
+        } else {
+            const std::string& name = loadedPool->getNames().store(record.name);
+            index.insert(name, seeds.size());
+            seeds.push_back({record.kind, &name, record.x, record.y, record.alive});
         }
     }
+    std::sort(loadErrors.begin(), loadErrors.end(),
+              [](const CsvError& a, const CsvError& b) { return a.line < b.line; });
     
-    file.close();
-    notify("Loaded " + std::to_string(count) + " NPCs from " + filename);
+    std::vector<std::shared_ptr<NPC>> loaded(seeds.size());
+    size_t workers = loader.getWorkers();
+    loader.getPool().run([&](size_t worker) {
+        size_t begin = seeds.size() * worker / workers;
+        size_t end = seeds.size() * (worker + 1) / workers;
+        if (begin == end) return;
+        NPCPool workerPool(loadedPool->shareNames());
+        workerPool.createBatch(seeds.data() + begin, end - begin, loaded.data() + begin);
+    });
+    
+    adopt(loaded, std::move(loadedPool), index);
+    if (journal) checkpoint();
+    
+    const size_t reportLimit = 10;
+    if (wants(EventKind::LoadProblem)) {
+        for (size_t i = 0; i < loadErrors.size() && i < reportLimit; i++) {
+            Event problem = counted(EventKind::LoadProblem, loadErrors[i].line, filename);
+            problem.text = loadErrors[i].message;
+            notify(std::move(problem));
+        }
+    }
+    if (loadErrors.size() > reportLimit) {
+        fail("... " + std::to_string(loadErrors.size() - reportLimit) + " more malformed lines");
+    }
+    
+    if (wants(EventKind::Loaded)) {
+        Event loadedEvent = counted(EventKind::Loaded, npcs.size(), filename);
+        loadedEvent.extra = loadErrors.size();
+        notify(std::move(loadedEvent));
+    }
+    return true;
+}
+
+bool Core::writeSnapshot(const std::string& filename, bool aliveOnly, size_t& written) const {
+    WorldFileWriter writer;
+    writer.reserve(npcs.size());
+    for (const auto& npc : npcs) {
+        if (npc->isAlive() || !aliveOnly) {
+            writer.add(npc->getType(), npc->getName(), npc->getX(), npc->getY(), npc->isAlive());
+        }
+    }
+    written = writer.size();
+    return writer.save(filename);
+}
+
+bool Core::saveSnapshot(const std::string& filename) {
+    size_t written = 0;
+    if (!writeSnapshot(filename, true, written)) {
+        fail("Failed to open file for writing: " + filename);
+        return false;
+    }
+    if (wants(EventKind::Saved)) notify(counted(EventKind::Saved, written, filename));
+    return true;
+}
+
+bool Core::loadSnapshot(const std::string& filename) {
+    loadErrors.clear();
+    WorldFile world;
+    std::string error;
+    if (!world.open(filename, error)) {
+        fail("Failed to load world file " + filename + ": " + error);
+        return false;
+    }
+    
+    std::vector<NPCKind> kinds(world.type_count());
+    for (size_t code = 0; code < world.type_count(); code++) {
+        if (!NPCFactory::kindFromName(world.type_name(code), kinds[code])) {
+            fail("Failed to load world file " + filename + ": unknown NPC type '" +
+                 std::string(world.type_name(code)) + "'");
+            return false;
+        }
+    }
+    
+    auto loadedPool = std::make_unique<NPCPool>();
+    NameIndex index;
+    index.reserve(world.size());
+    std::vector<NPCSeed> seeds(world.size());
+    for (size_t i = 0; i < world.size(); i++) {
+        std::string problem;
+        int x = world.xs()[i];
+        int y = world.ys()[i];
+        if (x < NPC::MIN_COORD || x > NPC::MAX_COORD || y < NPC::MIN_COORD || y > NPC::MAX_COORD) {
+            problem = "coordinates out of range for '" + std::string(world.name(i)) + "'";
+        } else if (index.find(world.name(i)) != NameIndex::npos) {
+            problem = "duplicate name '" + std::string(world.name(i)) + "'";
+        }
+        if (!problem.empty()) {
+            fail("Failed to load world file " + filename + ": " + problem);
+            return false;
+        }
+        
+        const std::string& name = loadedPool->getNames().store(world.name(i));
+        index.insert(name, i);
+        seeds[i] = {kinds[world.types()[i]], &name, x, y, world.alive()[i] != 0};
+    }
+    
+    std::vector<std::shared_ptr<NPC>> loaded(seeds.size());
+    loadedPool->createBatch(seeds.data(), seeds.size(), loaded.data());
+    adopt(loaded, std::move(loadedPool), index);
+    if (journal) checkpoint();
+    if (wants(EventKind::Loaded)) notify(counted(EventKind::Loaded, npcs.size(), filename));
+    return true;
+}
+
+bool Core::moveNPC(const std::string& name, int x, int y) {
+    size_t slot = nameIndex.find(name);
+    if (slot == NameIndex::npos) {
+        fail("Failed to move NPC: no NPC named '" + name + "'");
+        return false;
+    }
+    
+    const auto& npc = npcs[slot];
+    npc->setPosition(x, y);
+    if (npc->getX() != x || npc->getY() != y) {
+        fail("Failed to move NPC: coordinates must be between 0 and 500");
+        return false;
+    }
+    
+    if (journal) {
+        journal->append(JournalOp::Move, npc->getKind(), name, x, y);
+        journalCommit();
+    }
+    if (wants(EventKind::NPCMoved)) notify({EventKind::NPCMoved, npc, nullptr, x, y});
+    return true;
+}
+
+void Core::clear() {
+    size_t removed = npcs.size();
+    npcs.clear();
+    nameIndex.clear();
+    pool = std::make_unique<NPCPool>();
+    if (journal) {
+        journal->append(JournalOp::Clear);
+        journalCommit();
+    }
+    if (wants(EventKind::Cleared)) notify(counted(EventKind::Cleared, removed));
+}
+
+// Recovery state is the latest snapshot plus the journal written after it.
+// Replay is idempotent (adds of existing names and deaths of missing ones are
+// ignored), so a crash between writing the snapshot and resetting the journal
+// still recovers the same world.
+bool Core::openJournal(const std::string& basePath) {
+    closeJournal();
+    journalBase = basePath;
+    
+    std::string snapshotPath = basePath + ".bfw";
+    if (world_file::has_magic(snapshotPath) && !loadSnapshot(snapshotPath)) return false;
+    
+    std::vector<JournalEntry> entries;
+    std::string error;
+    auto opened = std::make_unique<Journal>();
+    if (!opened->open(basePath + ".journal", entries, error)) {
+        fail("Failed to open journal: " + error);
+        return false;
+    }
+    
+    replayJournal(entries);
+    journal = std::move(opened);
+    if (wants(EventKind::Recovered)) {
+        Event recovered = counted(EventKind::Recovered, npcs.size(), basePath);
+        recovered.extra = entries.size();
+        notify(std::move(recovered));
+    }
     return true;
 }
 
+void Core::replayJournal(const std::vector<JournalEntry>& entries) {
+    for (const auto& entry : entries) {
+        size_t slot = nameIndex.find(entry.name);
+        switch (entry.op) {
+            case JournalOp::Add:
+                if (slot != NameIndex::npos) break;
+                try {
+                    auto npc = NPCFactory::createNPC(entry.kind, *pool, entry.name, entry.x, entry.y);
+                    nameIndex.insert(npc->getName(), npcs.size());
+                    npcs.push_back(std::move(npc));
+                } catch (const std::exception& e) {
+                    fail("Skipped journal entry for '" + entry.name + "': " + e.what());
+                }
+                break;
+            case JournalOp::Move:
+                if (slot != NameIndex::npos) npcs[slot]->setPosition(entry.x, entry.y);
+                break;
+            case JournalOp::Death:
+                if (slot != NameIndex::npos) {
+                    npcs[slot] = nullptr;
+                    nameIndex.erase(entry.name);
+                }
+                break;
+            case JournalOp::Clear:
+                npcs.clear();
+                nameIndex.clear();
+                break;
+        }
+    }
+    
+    npcs.erase(std::remove(npcs.begin(), npcs.end(), nullptr), npcs.end());
+    rebuildIndex();
+}
+
+void Core::journalCommit() {
+    journal->flush();
+    if (journal->getEntryCount() > std::max(JOURNAL_COMPACT_MIN, npcs.size())) checkpoint();
+}
+
+bool Core::checkpoint() {
+    if (!journal) return false;
+    
+    std::string snapshotPath = journalBase + ".bfw";
+    std::string temporary = snapshotPath + ".tmp";
+    size_t written = 0;
+    if (!writeSnapshot(temporary, false, written) || std::rename(temporary.c_str(), snapshotPath.c_str()) != 0) {
+        fail("Failed to write checkpoint " + snapshotPath);
+        return false;
+    }
+    return journal->reset();
+}
+
+void Core::closeJournal() {
+    journal.reset();
+    journalBase.clear();
+}
+
 void Core::printAll() const {
     std::cout << "\n=== NPC List (" << npcs.size() << " total) ===" << std::endl;
     if (npcs.empty()) {
@@ -98,44 +476,102 @@ void Core::printAll() const {
 }
 
 void Core::simulateBattle(double range) {
-    notify("Starting battle simulation with range " + std::to_string(range));
+    ScopedTimer timer(battleLatency);
+    if (wants(EventKind::BattleStarted)) {
+        Event started{EventKind::BattleStarted};
+        started.range = range;
+        notify(std::move(started));
+    }
     
     auto npcsCopy = npcs;
+    size_t count = npcsCopy.size();
+    bool reportKills = wants(EventKind::Kill);
+    
+    // Each NPC gets a small code (0 for dead, otherwise 1 + its kind) so the
+    // join can look up both kill directions of a pair in one table.
+    constexpr size_t codes = NPC_KIND_COUNT + 1;
+    std::vector<uint8_t> code(count);
+    std::vector<int> xs(count), ys(count);
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = npcsCopy[i]->getX();
+        ys[i] = npcsCopy[i]->getY();
+        if (npcsCopy[i]->isAlive()) code[i] = static_cast<uint8_t>(npcsCopy[i]->getKind()) + 1;
+    }
     
-    for (size_t i = 0; i < npcsCopy.size(); i++) {
-        auto attacker = npcsCopy[i];
-        if (!attacker->isAlive()) continue;
+    uint8_t outcome[codes * codes] = {};
+    for (size_t a = 1; a < codes; a++) {
+        for (size_t b = 1; b < codes; b++) {
+            if (canDefeat(static_cast<NPCKind>(a - 1), static_cast<NPCKind>(b - 1))) {
+                outcome[a * codes + b] |= 1;
+                outcome[b * codes + a] |= 2;
+            }
+        }
+    }
+    
+    // Only ordered pairs that can end in a kill are kept, grouped by attacker
+    // so they replay in the same (attacker, defender) order as a full scan.
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    candidates.reserve(count);
+    std::vector<uint32_t> offsets(count + 1, 0);
+    RangeJoin join(range);
+    join.forEachPair(xs, ys, [&](uint32_t a, uint32_t b) {
+        uint8_t result = outcome[code[a] * codes + code[b]];
+        if (!result) return;
+        if (result & 1) {
+            candidates.push_back({a, b});
+            offsets[a + 1]++;
+        }
+        if (result & 2) {
+            candidates.push_back({b, a});
+            offsets[b + 1]++;
+        }
+    });
+    
+    battleCandidates.add(candidates.size());
+    for (size_t i = 0; i < count; i++) offsets[i + 1] += offsets[i];
+    std::vector<uint32_t> defenders(candidates.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& candidate : candidates) {
+        defenders[cursor[candidate.first]++] = candidate.second;
+    }
+    
+    size_t kills = 0;
+    for (size_t i = 0; i < count; i++) {
+        const auto& attacker = npcsCopy[i];
+        if (!attacker->isAlive() || offsets[i] == offsets[i + 1]) continue;
         
-        for (size_t j = 0; j < npcsCopy.size(); j++) {
-            if (i == j) continue;
-            
-            auto defender = npcsCopy[j];
+        auto begin = defenders.begin() + offsets[i];
+        auto end = defenders.begin() + offsets[i + 1];
+        std::sort(begin, end);
+        
+        // Every candidate already passed the range and outcome checks, so a
+        // defender that is still alive here loses.
+        for (auto it = begin; it != end; ++it) {
+            const auto& defender = npcsCopy[*it];
             if (!defender->isAlive()) continue;
             
-            if (attacker->distanceTo(*defender) > range) continue;
-            
-            BattleVisitor visitor(attacker, range);
-            visitor.setDefender(defender);
-            
-            defender->accept(visitor);
-            
-            if (visitor.didBattleOccur()) {
-                std::string message = attacker->getType() + " '" + 
-                                     attacker->getName() + "' defeated " +
-                                     defender->getType() + " '" + 
-                                     defender->getName() + "'";
-                notify(message);
-            }
+            defender->die();
+            kills++;
+            if (reportKills) notify({EventKind::Kill, attacker, defender});
         }
     }
     
     size_t before = npcs.size();
+    if (journal) {
+        for (const auto& npc : npcs) {
+            if (!npc->isAlive()) journal->append(JournalOp::Death, npc->getKind(), npc->getName());
+        }
+    }
     npcs.erase(std::remove_if(npcs.begin(), npcs.end(),
                [](const std::shared_ptr<NPC>& npc) { return !npc->isAlive(); }),
                npcs.end());
     size_t after = npcs.size();
+    battleRuns.add();
+    battleKills.add(kills);
+    if (after != before) rebuildIndex();
+    if (journal) journalCommit();
     
-    notify("Battle finished. Removed " + std::to_string(before - after) + " dead NPCs");
+    if (wants(EventKind::BattleFinished)) notify(counted(EventKind::BattleFinished, before - after));
 }
 
 size_t Core::getNPCCount() const { 
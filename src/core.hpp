@@ -5,28 +5,85 @@
 #include "factory_npc.hpp"
 #include "visitor_simulate_fight.hpp"
 #include "observer.hpp"
+#include "range_join.hpp"
+#include "world_file.hpp"
+#include "csv_loader.hpp"
+#include "journal.hpp"
+#include "npc_pool.hpp"
+#include "name_index.hpp"
+#include "metrics.hpp"
 #include <vector>
 #include <memory>
 #include <fstream>
 #include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <string_view>
+#include <cstdio>
+
+struct NPCSpec {
+    std::string_view type;
+    std::string_view name;
+    int x;
+    int y;
+};
 
 class Core : public Observable {
 private:
+    std::unique_ptr<NPCPool> pool;
     std::vector<std::shared_ptr<NPC>> npcs;
+    NameIndex nameIndex;
+    std::unique_ptr<ConsoleObserver> consoleObserver;
+    std::unique_ptr<FileObserver> fileObserver;
+    bool consoleOutput;
+    bool fileOutput;
+    std::vector<CsvError> loadErrors;
+    std::unique_ptr<Journal> journal;
+    std::string journalBase;
+    MetricsRegistry metrics;
+    Counter& battleRuns;
+    Counter& battleCandidates;
+    Counter& battleKills;
+    Histogram& battleLatency;
+    
+    static constexpr size_t JOURNAL_COMPACT_MIN = 1024;
     
-    bool isNameUnique(const std::string& name) const;
+    void fail(std::string message);
+    bool isNameUnique(std::string_view name) const;
+    void rebuildIndex();
+    void adopt(std::vector<std::shared_ptr<NPC>>& loaded, std::unique_ptr<NPCPool> loadedPool, NameIndex& index);
+    bool writeSnapshot(const std::string& filename, bool aliveOnly, size_t& written) const;
+    void replayJournal(const std::vector<JournalEntry>& entries);
+    void journalCommit();
     
 public:
     Core();
     ~Core();
     
     bool addNPC(const std::string& type, const std::string& name, int x, int y);
+    bool addNPCs(const std::vector<NPCSpec>& batch);
     bool saveToFile(const std::string& filename);
     bool loadFromFile(const std::string& filename);
+    bool saveSnapshot(const std::string& filename);
+    bool loadSnapshot(const std::string& filename);
+    bool moveNPC(const std::string& name, int x, int y);
+    void clear();
     void printAll() const;
     void simulateBattle(double range);
     
+    bool openJournal(const std::string& basePath);
+    bool checkpoint();
+    void closeJournal();
+    
+    void setConsoleOutput(bool enabled);
+    void setFileOutput(bool enabled);
+    void setConsoleLevel(EventLevel level);
+    void setFileLevel(EventLevel level);
+    
+    const std::vector<CsvError>& getLoadErrors() const { return loadErrors; }
+    const MetricsRegistry& getMetrics() const { return metrics; }
+    
+    std::shared_ptr<const NPC> findNPC(std::string_view name) const;
     size_t getNPCCount() const;
     size_t getAliveCount() const;
     std::string npcInfo() const;
@@ -0,0 +1,78 @@
+#ifndef COUNTER_RNG_HPP
+#define COUNTER_RNG_HPP
+
+#include <array>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator. Every draw is a pure function of
+// (seed, stream, tick, a, b, block), so results do not depend on which
+// thread asks or in what order.
+class CounterRng {
+public:
+    enum Stream : uint32_t {
+        Spawn = 1,
+        Movement = 2,
+        Battle = 3,
+        Jitter = 4,
+        Dice = 5
+    };
+
+private:
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> counter;
+    std::array<uint32_t, 4> block;
+    unsigned used = 4;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
+
+    void refill() {
+        std::array<uint32_t, 4> ctr = counter;
+        std::array<uint32_t, 2> k = key;
+
+        for (int round = 0; round < 10; ++round) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(0xD2511F53u, ctr[0], hi0, lo0);
+            mulhilo(0xCD9E8D57u, ctr[2], hi1, lo1);
+            ctr = {hi1 ^ ctr[1] ^ k[0], lo1, hi0 ^ ctr[3] ^ k[1], lo0};
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+
+        block = ctr;
+        used = 0;
+        counter[0] += 1u;
+    }
+
+public:
+    CounterRng(uint64_t seed, Stream stream, uint64_t tick, uint32_t a, uint32_t b = 0)
+        : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+          counter{static_cast<uint32_t>(stream) << 24,
+                  static_cast<uint32_t>(tick) ^ (static_cast<uint32_t>(tick >> 32) * 0x85EBCA6Bu),
+                  a, b},
+          block{} {}
+
+    uint32_t next() {
+        if (used == 4) refill();
+        return block[used++];
+    }
+
+    int uniform(int low, int high) {
+        uint32_t range = static_cast<uint32_t>(high - low) + 1u;
+        uint64_t product = static_cast<uint64_t>(next()) * range;
+        uint32_t leftover = static_cast<uint32_t>(product);
+        if (leftover < range) {
+            uint32_t threshold = (0u - range) % range;
+            while (leftover < threshold) {
+                product = static_cast<uint64_t>(next()) * range;
+                leftover = static_cast<uint32_t>(product);
+            }
+        }
+        return low + static_cast<int>(product >> 32);
+    }
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef CSV_LOADER_HPP
+#define CSV_LOADER_HPP
+
+#include "npc.hpp"
+#include "factory_npc.hpp"
+#include "worker_pool.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <thread>
+
+struct CsvRecord {
+    std::string_view name;
+    int x;
+    int y;
+    size_t line;
+    NPCKind kind;
+    bool alive;
+};
+
+struct CsvError {
+    size_t line;
+    std::string message;
+};
+
+// Parses `type,name,x,y,alive` dumps. The text is split into byte ranges at
+// line boundaries, each range is parsed on its own worker, and the results
+// are concatenated in file order. Records point into the caller's buffer.
+class CsvLoader {
+private:
+    static constexpr size_t MIN_CHUNK_BYTES = 1 << 16;
+
+    WorkerPool pool;
+    std::vector<std::vector<CsvRecord>> chunkRecords;
+    std::vector<std::vector<CsvError>> chunkErrors;
+    std::vector<size_t> chunkLines;
+
+    static bool parseInt(std::string_view field, int& value) {
+        const char* end = field.data() + field.size();
+        auto result = std::from_chars(field.data(), end, value);
+        return !field.empty() && result.ec == std::errc() && result.ptr == end;
+    }
+
+    static void parseChunk(std::string_view text, std::vector<CsvRecord>& records,
+                           std::vector<CsvError>& errors, size_t& lines) {
+        records.clear();
+        errors.clear();
+        lines = 0;
+
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+            std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+            lines++;
+
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.empty()) continue;
+
+            CsvRecord record;
+            const char* error = parseLine(line, record);
+            record.line = lines;
+            if (error) errors.push_back({lines, error});
+            else records.push_back(record);
+        }
+    }
+
+public:
+    explicit CsvLoader(size_t workers = std::max(1u, std::thread::hardware_concurrency()))
+        : pool(workers) {}
+
+    size_t getWorkers() const { return pool.size(); }
+    WorkerPool& getPool() { return pool; }
+
+    // Returns nullptr on success, otherwise a static description of the problem.
+    static const char* parseLine(std::string_view line, CsvRecord& record) {
+        std::string_view fields[5];
+        size_t count = 0;
+        size_t start = 0;
+        while (count < 5) {
+            size_t comma = line.find(',', start);
+            if (comma == std::string_view::npos) {
+                fields[count++] = line.substr(start);
+                break;
+            }
+            fields[count++] = line.substr(start, comma - start);
+            start = comma + 1;
+            if (count == 5) return "too many fields";
+        }
+        if (count != 5) return "expected 5 fields";
+
+        if (!NPCFactory::kindFromName(fields[0], record.kind)) return "unknown NPC type";
+        if (!parseInt(fields[2], record.x)) return "bad x coordinate";
+        if (!parseInt(fields[3], record.y)) return "bad y coordinate";
+
+        int alive;
+        if (!parseInt(fields[4], alive)) return "bad alive flag";
+
+        record.name = fields[1];
+        record.alive = alive != 0;
+        return nullptr;
+    }
+
+    void parse(std::string_view text, std::vector<CsvRecord>& records, std::vector<CsvError>& errors) {
+        size_t chunks = std::max<size_t>(1, std::min(pool.size(), text.size() / MIN_CHUNK_BYTES));
+        std::vector<size_t> bounds(chunks + 1, text.size());
+        bounds[0] = 0;
+        for (size_t i = 1; i < chunks; ++i) {
+            size_t guess = std::max(bounds[i - 1], text.size() * i / chunks);
+            size_t newline = text.find('\n', guess);
+            bounds[i] = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+
+        chunkRecords.resize(chunks);
+        chunkErrors.resize(chunks);
+        chunkLines.assign(chunks, 0);
+        pool.run([&](size_t worker) {
+            for (size_t chunk = worker; chunk < chunks; chunk += pool.size()) {
+                parseChunk(text.substr(bounds[chunk], bounds[chunk + 1] - bounds[chunk]),
+                           chunkRecords[chunk], chunkErrors[chunk], chunkLines[chunk]);
+            }
+        });
+
+        size_t total = 0;
+        for (const auto& chunk : chunkRecords) total += chunk.size();
+        records.clear();
+        records.reserve(total);
+        errors.clear();
+
+        size_t lineBase = 0;
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            for (auto record : chunkRecords[chunk]) {
+                record.line += lineBase;
+                records.push_back(record);
+            }
+            for (auto& error : chunkErrors[chunk]) {
+                error.line += lineBase;
+                errors.push_back(std::move(error));
+            }
+            lineBase += chunkLines[chunk];
+        }
+    }
+};
+
+#endif
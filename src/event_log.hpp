@@ -0,0 +1,122 @@
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include "world_store.hpp"
+
+enum class LogEventKind : uint8_t {
+    GameInitialized,
+    GameStarted,
+    Kill,
+    FailedKill
+};
+
+struct LogEvent {
+    uint64_t timestamp_ns;
+    uint32_t attacker;
+    uint32_t defender;
+    uint32_t value;
+    LogEventKind kind;
+    uint8_t attack_roll;
+    uint8_t defense_roll;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(LogEvent) == 24, "LogEvent is a fixed-size binary record");
+
+namespace event_log {
+
+constexpr char BINARY_MAGIC[8] = {'B', 'F', '3', 'E', 'V', 'T', '0', '1'};
+
+inline LogEvent make_event(LogEventKind kind, uint64_t timestamp_ns, uint32_t value = 0) {
+    LogEvent event{};
+    event.kind = kind;
+    event.timestamp_ns = timestamp_ns;
+    event.value = value;
+    return event;
+}
+
+inline LogEvent make_battle_event(LogEventKind kind, uint64_t timestamp_ns,
+                                  size_t attacker, size_t defender,
+                                  int attack_roll, int defense_roll) {
+    LogEvent event{};
+    event.kind = kind;
+    event.timestamp_ns = timestamp_ns;
+    event.attacker = static_cast<uint32_t>(attacker);
+    event.defender = static_cast<uint32_t>(defender);
+    event.attack_roll = static_cast<uint8_t>(attack_roll);
+    event.defense_roll = static_cast<uint8_t>(defense_roll);
+    return event;
+}
+
+inline void append_npc(std::string& out, const WorldStore* world, uint32_t id) {
+    if (world && id < world->size()) {
+        out += world->type_name(id);
+        out += ' ';
+        out += world->name(id);
+    } else {
+        out += "NPC #";
+        out += std::to_string(id);
+    }
+}
+
+inline void format(std::string& out, const LogEvent& event, const WorldStore* world) {
+    out += "[LOG] ";
+    switch (event.kind) {
+        case LogEventKind::GameInitialized:
+            out += "Game initialized with ";
+            out += std::to_string(event.value);
+            out += " NPCs";
+            break;
+        case LogEventKind::GameStarted:
+            out += "Starting async game...";
+            break;
+        case LogEventKind::Kill:
+        case LogEventKind::FailedKill:
+            append_npc(out, world, event.attacker);
+            out += event.kind == LogEventKind::Kill ? " killed " : " failed to kill ";
+            append_npc(out, world, event.defender);
+            out += " (";
+            out += std::to_string(event.attack_roll);
+            out += " vs ";
+            out += std::to_string(event.defense_roll);
+            out += ")";
+            break;
+    }
+    out += '\n';
+}
+
+inline bool write_binary_header(std::ofstream& file) {
+    file.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    return static_cast<bool>(file);
+}
+
+inline void write_binary(std::ofstream& file, const LogEvent* events, size_t count) {
+    file.write(reinterpret_cast<const char*>(events), static_cast<std::streamsize>(count * sizeof(LogEvent)));
+}
+
+inline std::vector<LogEvent> read_binary(const std::string& filename) {
+    std::vector<LogEvent> events;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return events;
+
+    char magic[sizeof(BINARY_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+        return events;
+    }
+
+    LogEvent event;
+    while (file.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+}
+
+#endif
@@ -2,32 +2,48 @@
 #define FACTORY_NPC_HPP
 
 #include "npc.hpp"
-#include "rogue.hpp"
-#include "orc.hpp"
-#include "werewolf.hpp"
+#include "npc_pool.hpp"
 #include <memory>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
 class NPCFactory {
 public:
-    static std::shared_ptr<NPC> createNPC(const std::string& type, 
-                                          const std::string& name, 
-                                          int x, int y) {
+    static bool kindFromName(std::string_view type, NPCKind& kind) {
         if (type == "Rogue" || type == "Разбойник") {
-            return std::make_shared<Rogue>(name, x, y);
+            kind = NPCKind::Rogue;
         } else if (type == "Orc" || type == "Орк") {
-            return std::make_shared<Orc>(name, x, y);
+            kind = NPCKind::Orc;
         } else if (type == "Werewolf" || type == "Оборотень") {
-            return std::make_shared<Werewolf>(name, x, y);
+            kind = NPCKind::Werewolf;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    static std::shared_ptr<NPC> createNPC(NPCKind kind, NPCPool& pool, std::string_view name, int x, int y) {
+        return pool.create(kind, pool.getNames().store(name), x, y);
+    }
+    
+    static std::shared_ptr<NPC> createNPC(NPCKind kind, const std::string& name, int x, int y) {
+        return NPCPool::createStandalone(kind, name, x, y);
+    }
+    
+    static std::shared_ptr<NPC> createNPC(const std::string& type, 
+                                          const std::string& name, 
+                                          int x, int y) {
+        NPCKind kind;
+        if (!kindFromName(type, kind)) {
+            throw std::invalid_argument("Unknown NPC type: " + type);
         }
-        throw std::invalid_argument("Unknown NPC type: " + type);
+        return createNPC(kind, name, x, y);
     }
     
     static bool isValidType(const std::string& type) {
-        return type == "Rogue" || type == "Разбойник" ||
-               type == "Orc" || type == "Орк" ||
-               type == "Werewolf" || type == "Оборотень";
+        NPCKind kind;
+        return kindFromName(type, kind);
     }
     
     static void printAvailableTypes() {
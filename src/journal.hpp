@@ -0,0 +1,177 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include "npc.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unistd.h>
+
+enum class JournalOp : uint8_t {
+    Add = 1,
+    Move = 2,
+    Death = 3,
+    Clear = 4
+};
+
+// `kind` is only meaningful for records about one NPC; Clear has none.
+struct JournalEntry {
+    JournalOp op;
+    NPCKind kind;
+    int x;
+    int y;
+    std::string name;
+};
+
+// Append-only mutation log. Each record is
+//   [payload size:uint32][checksum:uint32][op:uint8][kind:uint8][x:int32][y:int32][name]
+// Records without an NPC store NO_KIND as their kind byte.
+// Replay stops at the first short or corrupt record, and the torn tail is cut
+// off before new records are appended.
+class Journal {
+private:
+    static constexpr char MAGIC[8] = {'B', 'F', '3', 'J', 'R', 'N', 'L', '1'};
+    static constexpr size_t FIXED_PAYLOAD = 2 * sizeof(uint8_t) + 2 * sizeof(int32_t);
+    static constexpr uint32_t MAX_PAYLOAD = 1 << 20;
+    static constexpr uint8_t NO_KIND = 0xFF;
+
+    std::string path;
+    std::ofstream file;
+    size_t entries = 0;
+    std::string record;
+
+    static uint32_t checksum(const char* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    static bool readEntry(std::ifstream& in, std::string& payload, JournalEntry& entry) {
+        uint32_t header[2];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+        if (header[0] < FIXED_PAYLOAD || header[0] > MAX_PAYLOAD) return false;
+
+        payload.resize(header[0]);
+        if (!in.read(&payload[0], header[0])) return false;
+        if (checksum(payload.data(), payload.size()) != header[1]) return false;
+
+        uint8_t op = static_cast<uint8_t>(payload[0]);
+        uint8_t kind = static_cast<uint8_t>(payload[1]);
+        if (op < 1 || op > 4) return false;
+        // Clear records written before NO_KIND existed carry a placeholder kind.
+        bool hasKind = op != static_cast<uint8_t>(JournalOp::Clear);
+        if (hasKind && kind >= NPC_KIND_COUNT) return false;
+
+        int32_t coords[2];
+        std::memcpy(coords, payload.data() + 2, sizeof(coords));
+        entry.op = static_cast<JournalOp>(op);
+        entry.kind = hasKind ? static_cast<NPCKind>(kind) : NPCKind::Rogue;
+        entry.x = coords[0];
+        entry.y = coords[1];
+        entry.name.assign(payload, FIXED_PAYLOAD, std::string::npos);
+        return true;
+    }
+
+    void write(JournalOp op, uint8_t kind, const std::string& name, int x, int y) {
+        if (!file.is_open()) return;
+
+        uint32_t size = static_cast<uint32_t>(FIXED_PAYLOAD + name.size());
+        record.assign(2 * sizeof(uint32_t), '\0');
+        record += static_cast<char>(op);
+        record += static_cast<char>(kind);
+        int32_t coords[2] = {x, y};
+        record.append(reinterpret_cast<const char*>(coords), sizeof(coords));
+        record += name;
+
+        uint32_t header[2] = {size, checksum(record.data() + sizeof(header), size)};
+        std::memcpy(&record[0], header, sizeof(header));
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+        entries++;
+    }
+
+public:
+    ~Journal() { close(); }
+
+    // Reads every intact record into `replay` and reopens the file for appending.
+    bool open(const std::string& filename, std::vector<JournalEntry>& replay, std::string& error) {
+        close();
+        path = filename;
+        replay.clear();
+
+        std::streamoff valid = 0;
+        std::ifstream in(path, std::ios::binary);
+        if (in.is_open()) {
+            char magic[sizeof(MAGIC)];
+            if (in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0) {
+                valid = sizeof(MAGIC);
+                std::string payload;
+                JournalEntry entry;
+                while (readEntry(in, payload, entry)) {
+                    replay.push_back(std::move(entry));
+                    valid = in.tellg();
+                }
+            } else if (in.gcount() > 0) {
+                error = "not a journal file: " + path;
+                return false;
+            }
+            in.close();
+        }
+
+        if (valid == 0) {
+            if (reset()) return true;
+            error = "cannot create journal " + path;
+            return false;
+        }
+        if (truncate(path.c_str(), valid) != 0) {
+            error = "cannot truncate journal " + path;
+            return false;
+        }
+        file.open(path, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            error = "cannot open journal " + path;
+            return false;
+        }
+        entries = replay.size();
+        return true;
+    }
+
+    void append(JournalOp op, NPCKind kind, const std::string& name, int x = 0, int y = 0) {
+        write(op, static_cast<uint8_t>(kind), name, x, y);
+    }
+
+    // For records that are not about an NPC (Clear).
+    void append(JournalOp op) {
+        write(op, NO_KIND, std::string(), 0, 0);
+    }
+
+    void flush() {
+        if (file.is_open()) file.flush();
+    }
+
+    // Starts an empty journal, used once a snapshot covers everything logged so far.
+    bool reset() {
+        close();
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(MAGIC, sizeof(MAGIC));
+        file.flush();
+        entries = 0;
+        return static_cast<bool>(file);
+    }
+
+    void close() {
+        if (file.is_open()) file.close();
+        entries = 0;
+    }
+
+    bool isOpen() const { return file.is_open(); }
+    size_t getEntryCount() const { return entries; }
+};
+
+#endif
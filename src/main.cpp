@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <limits>
+#include <string>
 
 void printMenu() {
     std::cout << "\n=== Balagur Fate 3 - Dungeon Editor ===" << std::endl;
@@ -33,20 +34,45 @@ void clearInput() {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-int main() {
+int main(int argc, char** argv) {
     std::srand(std::time(nullptr));
     Core dungeonCore;
+    dungeonCore.setAsync(true);
+    
+    std::string loadPath;
+    std::string journalBase;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--journal" && i + 1 < argc) {
+            journalBase = argv[++i];
+        } else if (loadPath.empty() && arg.rfind("--", 0) != 0) {
+            loadPath = arg;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--journal BASE] [FILE]" << std::endl;
+            return 1;
+        }
+    }
     
     int choice;
     bool running = true;
     
-    dungeonCore.addNPC("Rogue", "Shadow", 50, 50);
-    dungeonCore.addNPC("Orc", "Grom", 150, 150);
-    dungeonCore.addNPC("Werewolf", "Fenrir", 250, 250);
-    dungeonCore.addNPC("Rogue", "Bandit", 350, 350);
-    dungeonCore.addNPC("Werewolf", "Lycan", 450, 450);
+    if (!journalBase.empty() && !dungeonCore.openJournal(journalBase)) {
+        std::cerr << "Could not open journal '" << journalBase
+                  << "'; changes will not be journaled" << std::endl;
+    }
+    
+    if (!loadPath.empty()) {
+        dungeonCore.loadFromFile(loadPath);
+    } else if (dungeonCore.getNPCCount() == 0) {
+        dungeonCore.addNPC("Rogue", "Shadow", 50, 50);
+        dungeonCore.addNPC("Orc", "Grom", 150, 150);
+        dungeonCore.addNPC("Werewolf", "Fenrir", 250, 250);
+        dungeonCore.addNPC("Rogue", "Bandit", 350, 350);
+        dungeonCore.addNPC("Werewolf", "Lycan", 450, 450);
+    }
     
     while (running) {
+        dungeonCore.flush();
         printMenu();
         std::cin >> choice;
         clearInput();
@@ -83,7 +109,7 @@ int main() {
                 
             case 3: {
                 std::string filename;
-                std::cout << "Enter filename to save: ";
+                std::cout << "Enter filename to save (*.bfw for binary): ";
                 std::getline(std::cin, filename);
                 if (filename.empty()) filename = "dungeon_save.txt";
                 
@@ -126,9 +152,8 @@ int main() {
                 break;
                 
             case 8:
-                dungeonCore.saveToFile("backup.txt");
-                dungeonCore.loadFromFile("empty.txt");
-                std::cout << "Dungeon cleared! Backup saved to backup.txt" << std::endl;
+                dungeonCore.clear();
+                std::cout << "Dungeon cleared!" << std::endl;
                 break;
                 
             case 0:
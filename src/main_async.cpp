@@ -2,30 +2,187 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <string>
+#include <cstdlib>
+#include <random>
 
-int main() {
+struct Options {
+    bool headless = false;
+    long long ticks = 1000;
+    int npcs = 50;
+    int map_size = 100;
+    int movement_workers = 1;
+    int battle_workers = 1;
+    uint64_t seed = std::random_device{}();
+    std::string world_file;
+    std::string save_world_file;
+    std::string metrics_file;
+    std::string trace_file;
+};
+
+static bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](long long& value) {
+            if (i + 1 >= argc) return false;
+            value = std::atoll(argv[++i]);
+            return value > 0;
+        };
+        long long value = 0;
+        
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--ticks" && next(value)) {
+            options.ticks = value;
+        } else if (arg == "--npcs" && next(value)) {
+            options.npcs = static_cast<int>(value);
+        } else if (arg == "--map" && next(value)) {
+            options.map_size = static_cast<int>(value);
+        } else if (arg == "--movement-workers" && next(value)) {
+            options.movement_workers = static_cast<int>(value);
+        } else if (arg == "--battle-workers" && next(value)) {
+            options.battle_workers = static_cast<int>(value);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--world" && i + 1 < argc) {
+            options.world_file = argv[++i];
+        } else if (arg == "--save-world" && i + 1 < argc) {
+            options.save_world_file = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            options.metrics_file = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.trace_file = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--headless] [--ticks N] [--npcs N] [--map N]"
+                      << " [--movement-workers N] [--battle-workers N] [--seed N]"
+                      << " [--world FILE] [--save-world FILE] [--metrics FILE]"
+                      << " [--trace FILE]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool attach_world(AsyncGame& game, const Options& options) {
+    if (options.world_file.empty()) return true;
+    
+    std::string error;
+    if (!game.load_world(options.world_file, error)) {
+        std::cerr << "Failed to load world " << options.world_file << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void save_world(const AsyncGame& game, const Options& options) {
+    if (options.save_world_file.empty()) return;
+    if (!game.save_world(options.save_world_file)) {
+        std::cerr << "Failed to save world to " << options.save_world_file << std::endl;
+    }
+}
+
+// Dumps the game's metrics to the file every second while it lives;
+// *.json gets JSON, anything else Prometheus text.
+static std::unique_ptr<MetricsWriter> watch_metrics(const AsyncGame& game, const Options& options) {
+    if (options.metrics_file.empty()) return nullptr;
+    return std::make_unique<MetricsWriter>(game.get_metrics(), options.metrics_file);
+}
+
+static void write_trace(const Options& options) {
+    if (options.trace_file.empty()) return;
+    if (!trace::enabled) {
+        std::cerr << "--trace ignored: rebuild with -DBF3_TRACE=ON to record spans" << std::endl;
+        return;
+    }
+    if (!trace::Tracer::instance().write(options.trace_file)) {
+        std::cerr << "Failed to write trace to " << options.trace_file << std::endl;
+    }
+}
+
+static int run_headless(const Options& options) {
+    AsyncGame game(options.world_file.empty() ? options.npcs : 0, options.map_size, options.seed);
+    game.set_console_log(false);
+    game.set_movement_workers(options.movement_workers);
+    game.set_battle_workers(options.battle_workers);
+    if (!attach_world(game, options)) return 1;
+    
+    size_t npcs = game.get_npc_count();
+    auto metrics_writer = watch_metrics(game, options);
+    auto stats = game.run_headless(static_cast<uint64_t>(options.ticks));
+    metrics_writer.reset();
+    write_trace(options);
+    save_world(game, options);
+    
+    std::cout << "Headless run: " << npcs << " NPCs, map "
+              << options.map_size << "x" << options.map_size
+              << ", seed " << game.get_seed() << std::endl;
+    std::cout << "Ticks: " << stats.ticks << " in " << stats.seconds << " s" << std::endl;
+    std::cout << "Ticks per second: " << stats.ticks_per_second << std::endl;
+    std::cout << "Battles resolved: " << stats.battles_resolved << std::endl;
+    std::cout << "Survivors: " << stats.survivors << " out of " << npcs << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) return 1;
+    
+    if (options.headless) {
+        try {
+            return run_headless(options);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
     std::cout << "=== Balagur Fate 3 - Async Version ===" << std::endl;
-    std::cout << "NPC Types: Rogue, Orc, Werewolf, Pegasus" << std::endl;
+    std::cout << "NPC Types: ";
+    for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) {
+        std::cout << (i ? ", " : "") << NPC_TYPE_INFO[i].name;
+    }
+    std::cout << std::endl;
+    
     std::cout << "Battle Rules:" << std::endl;
-    std::cout << "  1. Rogue kills Werewolves" << std::endl;
-    std::cout << "  2. Werewolf kills Rogues" << std::endl;
-    std::cout << "  3. Orc kills Rogues" << std::endl;
-    std::cout << "  4. Pegasus doesn't kill anyone" << std::endl;
+    int rule = 1;
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a) {
+        bool kills_anyone = false;
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d) {
+            if (npc_can_kill(npc_type_at(a), npc_type_at(d))) {
+                std::cout << "  " << rule++ << ". " << NPC_TYPE_INFO[a].name
+                          << " kills " << NPC_TYPE_INFO[d].plural << std::endl;
+                kills_anyone = true;
+            }
+        }
+        if (!kills_anyone) {
+            std::cout << "  " << rule++ << ". " << NPC_TYPE_INFO[a].name
+                      << " doesn't kill anyone" << std::endl;
+        }
+    }
+    
     std::cout << "\nMovement rules:" << std::endl;
-    std::cout << "  - Rogue: move 10, kill distance 10" << std::endl;
-    std::cout << "  - Orc: move 20, kill distance 10" << std::endl;
-    std::cout << "  - Werewolf: move 40, kill distance 5" << std::endl;
-    std::cout << "  - Pegasus: move 30, kill distance 10" << std::endl;
+    for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) {
+        std::cout << "  - " << NPC_TYPE_INFO[i].name << ": move " << NPC_TYPE_INFO[i].move_distance
+                  << ", kill distance " << NPC_TYPE_INFO[i].kill_distance << std::endl;
+    }
     std::cout << "======================================\n" << std::endl;
     
-    std::cout << "Initializing game with 50 NPCs..." << std::endl;
+    std::cout << "Initializing game with " << options.npcs << " NPCs..." << std::endl;
     
-    AsyncGame game;
+    AsyncGame game(options.world_file.empty() ? options.npcs : 0, options.map_size, options.seed);
+    if (!attach_world(game, options)) return 1;
+    std::cout << "Seed: " << game.get_seed() << std::endl;
+    game.set_movement_workers(options.movement_workers);
+    game.set_battle_workers(options.battle_workers);
     
     std::cout << "Starting game for 30 seconds..." << std::endl;
     
     try {
+        auto metrics_writer = watch_metrics(game, options);
         game.run();
+        metrics_writer.reset();
+        write_trace(options);
+        save_world(game, options);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,74 @@
+#include "sharded_world.hpp"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <random>
+
+struct Options {
+    long long ticks = 100;
+    int npcs = 1000;
+    int map_size = 200;
+    int shards = 4;
+    uint64_t seed = std::random_device{}();
+};
+
+static bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](long long& value) {
+            if (i + 1 >= argc) return false;
+            value = std::atoll(argv[++i]);
+            return value > 0;
+        };
+        long long value = 0;
+        
+        if (arg == "--ticks" && next(value)) {
+            options.ticks = value;
+        } else if (arg == "--npcs" && next(value)) {
+            options.npcs = static_cast<int>(value);
+        } else if (arg == "--map" && next(value)) {
+            options.map_size = static_cast<int>(value);
+        } else if (arg == "--shards" && next(value)) {
+            options.shards = static_cast<int>(value);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--ticks N] [--npcs N] [--map N]"
+                      << " [--shards N] [--seed N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the world split across --shards processes and in a single AsyncGame
+// with the same seed, and exits non-zero unless both end in the same state.
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) return 1;
+    
+    try {
+        ShardCheck check = check_sharded_run(options.npcs, options.map_size, options.seed,
+                                             options.shards, static_cast<uint64_t>(options.ticks));
+        
+        std::cout << "Sharded run: " << check.npcs << " NPCs, map "
+                  << options.map_size << "x" << options.map_size << ", " << options.shards
+                  << " shards, " << options.ticks << " ticks, seed " << options.seed << std::endl;
+        std::cout << "Handoffs: " << check.handoffs << ", ghost copies: " << check.ghosts << std::endl;
+        std::cout << "Battles resolved: " << check.battles_sharded << " sharded, "
+                  << check.battles_single << " single-process" << std::endl;
+        std::cout << "Survivors: " << check.survivors << " out of " << check.npcs << std::endl;
+        
+        if (!check.matches()) {
+            std::cout << "MISMATCH: " << check.mismatches << " NPCs differ";
+            if (!check.first_mismatch.empty()) std::cout << ", first " << check.first_mismatch;
+            std::cout << std::endl;
+            return 2;
+        }
+        std::cout << "Sharded and single-process runs match" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
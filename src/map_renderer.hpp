@@ -0,0 +1,129 @@
+#ifndef MAP_RENDERER_HPP
+#define MAP_RENDERER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include "npc_types.hpp"
+
+// Persistent downsampled framebuffer. Each output cell keeps a per-type count
+// of the NPCs inside it, so a frame only pays for the NPCs that were touched
+// since the last one plus a pass over the viewport. A cell holding several
+// types shows the first of them in NPCType order (Rogue, Orc, Werewolf), not
+// whichever NPC happened to be drawn last.
+class MapRenderer {
+public:
+    struct Viewport {
+        int x;
+        int y;
+        int cols;
+        int rows;
+        int zoom;
+    };
+
+private:
+    Viewport view;
+    uint64_t generation = 0;
+    std::vector<uint32_t> counts;
+    std::vector<int32_t> npc_cell;
+    std::vector<NPCType> npc_type;
+
+    void place(size_t id, int32_t cell, NPCType type) {
+        int32_t old = npc_cell[id];
+        if (old == cell && npc_type[id] == type) return;
+        if (old != HIDDEN) counts[old * NPC_TYPE_COUNT + npc_type_index(npc_type[id])]--;
+        if (cell != HIDDEN) counts[cell * NPC_TYPE_COUNT + npc_type_index(type)]++;
+        npc_cell[id] = cell;
+        npc_type[id] = type;
+    }
+
+    char glyph_at(int32_t cell) const {
+        const uint32_t* row = &counts[cell * NPC_TYPE_COUNT];
+        for (size_t t = 0; t < NPC_TYPE_COUNT; ++t) {
+            if (row[t]) return NPC_TYPE_INFO[t].glyph;
+        }
+        return '.';
+    }
+
+public:
+    static constexpr int32_t HIDDEN = -1;
+
+    explicit MapRenderer(const Viewport& viewport) { set_viewport(viewport); }
+
+    static int32_t cell_of(const Viewport& view, int x, int y) {
+        int cx = x - view.x;
+        int cy = y - view.y;
+        if (cx < 0 || cy < 0) return HIDDEN;
+        cx /= view.zoom;
+        cy /= view.zoom;
+        if (cx >= view.cols || cy >= view.rows) return HIDDEN;
+        return cy * view.cols + cx;
+    }
+
+    static Viewport fit(int map_width, int map_height, int display_size) {
+        int zoom = std::max(1, std::max(map_width, map_height) / display_size);
+        return {0, 0, (map_width + zoom - 1) / zoom, (map_height + zoom - 1) / zoom, zoom};
+    }
+
+    const Viewport& get_viewport() const { return view; }
+
+    // Bumped by every set_viewport(), so callers can tell whether cells they
+    // computed against an earlier viewport still apply.
+    uint64_t get_generation() const { return generation; }
+
+    void set_viewport(const Viewport& viewport) {
+        if (viewport.cols <= 0 || viewport.rows <= 0 || viewport.zoom <= 0) {
+            throw std::invalid_argument("Viewport must have positive size and zoom");
+        }
+        view = viewport;
+        generation++;
+        counts.assign(static_cast<size_t>(view.cols) * view.rows * NPC_TYPE_COUNT, 0);
+        std::fill(npc_cell.begin(), npc_cell.end(), HIDDEN);
+    }
+
+    template <typename World>
+    void rebuild(const World& world) {
+        std::fill(counts.begin(), counts.end(), 0);
+        npc_cell.assign(world.size(), HIDDEN);
+        npc_type.assign(world.size(), NPCType::None);
+        for (size_t id = 0; id < world.size(); ++id) {
+            touch(id, world);
+        }
+    }
+
+    template <typename World>
+    void touch(size_t id, const World& world) {
+        if (id >= npc_cell.size()) {
+            npc_cell.resize(id + 1, HIDDEN);
+            npc_type.resize(id + 1, NPCType::None);
+        }
+        NPCType type = world.type_id[id];
+        bool visible = world.alive[id] != 0 && npc_type_valid(type);
+        place(id, visible ? cell_of(view, world.x[id], world.y[id]) : HIDDEN, type);
+    }
+
+    char glyph(int col, int row) const {
+        return glyph_at(row * view.cols + col);
+    }
+
+    void compose(std::string& out) const {
+        for (int row = 0; row < view.rows; ++row) {
+            for (int col = 0; col < view.cols; ++col) {
+                out += glyph_at(row * view.cols + col);
+            }
+            out += '\n';
+        }
+    }
+
+    static void append_number(std::string& out, long long value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+};
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace metrics {
+
+constexpr size_t SHARDS = 16;
+constexpr size_t MAX_BUCKETS = 16;
+
+// Each thread is pinned to one shard on first use, so hot updates from
+// different threads land on different cache lines.
+inline size_t thread_shard() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t shard = next++ % SHARDS;
+    return shard;
+}
+
+// Upper bounds in nanoseconds, 1 us to 10 s.
+inline std::vector<uint64_t> latency_buckets() {
+    return {1000, 10000, 50000, 100000, 500000, 1000000, 5000000, 10000000,
+            50000000, 100000000, 500000000, 1000000000, 10000000000ull};
+}
+
+inline uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+}
+
+class Counter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, metrics::SHARDS> shards;
+
+public:
+    void add(uint64_t amount = 1) {
+        shards[metrics::thread_shard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards) total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
+class Histogram {
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, metrics::MAX_BUCKETS + 1> buckets{};
+        std::atomic<uint64_t> sum{0};
+    };
+    std::vector<uint64_t> bounds;
+    std::array<Shard, metrics::SHARDS> shards;
+
+public:
+    struct Totals {
+        std::vector<uint64_t> cumulative;
+        uint64_t count = 0;
+        uint64_t sum = 0;
+    };
+
+    explicit Histogram(std::vector<uint64_t> bucket_bounds = metrics::latency_buckets())
+        : bounds(std::move(bucket_bounds)) {
+        if (bounds.empty() || bounds.size() > metrics::MAX_BUCKETS) {
+            throw std::invalid_argument("Histogram needs 1 to 16 bucket bounds");
+        }
+    }
+
+    const std::vector<uint64_t>& get_bounds() const { return bounds; }
+
+    void observe(uint64_t value) {
+        size_t bucket = 0;
+        while (bucket < bounds.size() && value > bounds[bucket]) bucket++;
+        Shard& shard = shards[metrics::thread_shard()];
+        shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // The last cumulative entry is the +Inf bucket, i.e. the total count.
+    Totals totals() const {
+        Totals result;
+        result.cumulative.assign(bounds.size() + 1, 0);
+        for (const auto& shard : shards) {
+            for (size_t i = 0; i <= bounds.size(); ++i) {
+                result.cumulative[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            }
+            result.sum += shard.sum.load(std::memory_order_relaxed);
+        }
+        for (size_t i = 1; i < result.cumulative.size(); ++i) {
+            result.cumulative[i] += result.cumulative[i - 1];
+        }
+        result.count = result.cumulative.back();
+        return result;
+    }
+};
+
+class ScopedTimer {
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    explicit ScopedTimer(Histogram& histogram) : histogram(histogram) {}
+    ~ScopedTimer() { histogram.observe(metrics::elapsed_ns(start)); }
+};
+
+// Named metrics, aggregated only when dumped. Counters and histograms are
+// owned by the registry; probes read existing state (queue depths, atomics)
+// at dump time. Histograms record nanoseconds and are exported in seconds.
+class MetricsRegistry {
+public:
+    enum class Type { Counter, Gauge, Histogram };
+
+private:
+    struct Entry {
+        std::string name;
+        std::string help;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> probe;
+    };
+
+    mutable std::mutex mutex;
+    std::deque<Entry> entries;
+
+    Entry& add_entry(const std::string& name, const std::string& help, Type type) {
+        for (const auto& entry : entries) {
+            if (entry.name == name) throw std::invalid_argument("Duplicate metric: " + name);
+        }
+        entries.push_back({name, help, type, nullptr, nullptr, nullptr});
+        return entries.back();
+    }
+
+    static void append_value(std::string& out, double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        out += buffer;
+    }
+
+    static double entry_value(const Entry& entry) {
+        return entry.counter ? static_cast<double>(entry.counter->value()) : entry.probe();
+    }
+
+public:
+    Counter& counter(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = add_entry(name, help, Type::Counter);
+        entry.counter = std::make_unique<Counter>();
+        return *entry.counter;
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         std::vector<uint64_t> bounds = metrics::latency_buckets()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = add_entry(name, help, Type::Histogram);
+        entry.histogram = std::make_unique<Histogram>(std::move(bounds));
+        return *entry.histogram;
+    }
+
+    void probe(const std::string& name, const std::string& help, Type type, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(mutex);
+        add_entry(name, help, type).probe = std::move(read);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    std::string prometheus() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string out;
+        for (const auto& entry : entries) {
+            out += "# HELP " + entry.name + " " + entry.help + "\n# TYPE " + entry.name + " ";
+            if (entry.type != Type::Histogram) {
+                out += entry.type == Type::Counter ? "counter\n" : "gauge\n";
+                out += entry.name + " ";
+                append_value(out, entry_value(entry));
+                out += '\n';
+                continue;
+            }
+
+            out += "histogram\n";
+            auto totals = entry.histogram->totals();
+            const auto& bounds = entry.histogram->get_bounds();
+            for (size_t i = 0; i <= bounds.size(); ++i) {
+                out += entry.name + "_bucket{le=\"";
+                if (i < bounds.size()) append_value(out, bounds[i] * 1e-9);
+                else out += "+Inf";
+                out += "\"} " + std::to_string(totals.cumulative[i]) + "\n";
+            }
+            out += entry.name + "_sum ";
+            append_value(out, totals.sum * 1e-9);
+            out += "\n" + entry.name + "_count " + std::to_string(totals.count) + "\n";
+        }
+        return out;
+    }
+
+    std::string json() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string out = "{";
+        for (size_t e = 0; e < entries.size(); ++e) {
+            const Entry& entry = entries[e];
+            out += e ? ",\n  \"" : "\n  \"";
+            out += entry.name + "\": ";
+            if (entry.type != Type::Histogram) {
+                append_value(out, entry_value(entry));
+                continue;
+            }
+
+            auto totals = entry.histogram->totals();
+            const auto& bounds = entry.histogram->get_bounds();
+            out += "{\"buckets\": [";
+            for (size_t i = 0; i < bounds.size(); ++i) {
+                out += i ? ", [" : "[";
+                append_value(out, bounds[i] * 1e-9);
+                out += ", " + std::to_string(totals.cumulative[i]) + "]";
+            }
+            out += "], \"sum\": ";
+            append_value(out, totals.sum * 1e-9);
+            out += ", \"count\": " + std::to_string(totals.count) + "}";
+        }
+        out += "\n}\n";
+        return out;
+    }
+
+    // Writes through a temporary file and a rename, so a scraper never sees a
+    // partial dump. Files ending in .json get JSON, anything else Prometheus text.
+    bool write(const std::string& filename) const {
+        bool as_json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+        std::string text = as_json ? json() : prometheus();
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(text.data(), static_cast<std::streamsize>(text.size()));
+            if (!file) return false;
+        }
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+    }
+};
+
+// Rewrites a registry dump every `interval` until destroyed, then once more.
+class MetricsWriter {
+private:
+    const MetricsRegistry& registry;
+    std::string filename;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread thread;
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            lock.unlock();
+            registry.write(filename);
+            lock.lock();
+            cv.wait_for(lock, interval, [this]() { return stopping; });
+        }
+    }
+
+public:
+    MetricsWriter(const MetricsRegistry& registry, std::string filename,
+                  std::chrono::milliseconds interval = std::chrono::milliseconds(1000))
+        : registry(registry), filename(std::move(filename)), interval(interval),
+          thread(&MetricsWriter::loop, this) {}
+
+    MetricsWriter(const MetricsWriter&) = delete;
+    MetricsWriter& operator=(const MetricsWriter&) = delete;
+
+    ~MetricsWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        thread.join();
+        registry.write(filename);
+    }
+};
+
+#endif
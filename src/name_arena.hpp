@@ -0,0 +1,30 @@
+#ifndef NAME_ARENA_HPP
+#define NAME_ARENA_HPP
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Block-allocated name storage. References stay valid until the arena is
+// destroyed, so NPCs keep a pointer instead of owning a string, and short
+// names sit inline next to each other. store() copies on every call; names
+// are not interned, since Core already rejects duplicates. Not thread-safe.
+class NameArena {
+private:
+    std::deque<std::string> names;
+
+public:
+    NameArena() = default;
+    NameArena(const NameArena&) = delete;
+    NameArena& operator=(const NameArena&) = delete;
+
+    const std::string& store(std::string_view name) {
+        names.emplace_back(name);
+        return names.back();
+    }
+
+    size_t size() const { return names.size(); }
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef NAME_INDEX_HPP
+#define NAME_INDEX_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// Open-addressing name -> slot map over names that live in a NameArena.
+// Entries are flat (pointer, hash, slot), probed linearly, with tombstones
+// for erase, so lookups touch one cache line plus the name itself.
+class NameIndex {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    static constexpr uint32_t ERASED = UINT32_MAX - 1;
+
+    struct Entry {
+        const std::string* name;
+        uint32_t hash;
+        uint32_t slot;
+    };
+
+    std::vector<Entry> table;
+    size_t count = 0;
+    size_t used = 0;
+
+    static uint32_t hashOf(std::string_view name) {
+        return static_cast<uint32_t>(std::hash<std::string_view>{}(name));
+    }
+
+    size_t probe(std::string_view name, uint32_t hash) const {
+        size_t mask = table.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Entry& entry = table[i];
+            if (entry.slot == EMPTY) return i;
+            if (entry.slot != ERASED && entry.hash == hash && *entry.name == name) return i;
+        }
+    }
+
+    // `capacity` must be a power of two.
+    void rehash(size_t capacity) {
+        std::vector<Entry> old;
+        old.swap(table);
+        table.assign(capacity, Entry{nullptr, 0, EMPTY});
+        used = count;
+        for (const Entry& entry : old) {
+            if (entry.slot == EMPTY || entry.slot == ERASED) continue;
+            size_t mask = table.size() - 1;
+            size_t i = entry.hash & mask;
+            while (table[i].slot != EMPTY) i = (i + 1) & mask;
+            table[i] = entry;
+        }
+    }
+
+public:
+    size_t size() const { return count; }
+
+    void reserve(size_t entries) {
+        size_t capacity = 16;
+        while (capacity < entries * 2) capacity *= 2;
+        if (capacity > table.size()) rehash(capacity);
+    }
+
+    void clear() {
+        table.clear();
+        count = 0;
+        used = 0;
+    }
+
+    size_t find(std::string_view name) const {
+        if (table.empty()) return npos;
+        const Entry& entry = table[probe(name, hashOf(name))];
+        return entry.slot == EMPTY ? npos : entry.slot;
+    }
+
+    // `name` must outlive the index entry. Returns false if it is already present.
+    bool insert(const std::string& name, size_t slot) {
+        if ((used + 1) * 2 > table.size()) {
+            size_t capacity = 16;
+            while (capacity < (count + 1) * 4) capacity *= 2;
+            rehash(capacity);
+        }
+
+        uint32_t hash = hashOf(name);
+        size_t i = probe(name, hash);
+        if (table[i].slot != EMPTY) return false;
+        table[i] = Entry{&name, hash, static_cast<uint32_t>(slot)};
+        count++;
+        used++;
+        return true;
+    }
+
+    bool erase(std::string_view name) {
+        if (table.empty()) return false;
+        size_t i = probe(name, hashOf(name));
+        if (table[i].slot == EMPTY) return false;
+        table[i].slot = ERASED;
+        count--;
+        return true;
+    }
+};
+
+#endif
@@ -2,21 +2,26 @@
 #include "visitor_simulate_fight.hpp"
 #include "factory_npc.hpp"
 
-NPC::NPC(const std::string& name, int x, int y) 
-    : name(name), x(x), y(y), alive(true) {
-    if (x < 0 || x > 500 || y < 0 || y > 500) {
+const std::string& npcKindName(NPCKind kind) {
+    static const std::string names[NPC_KIND_COUNT] = {"Rogue", "Orc", "Werewolf"};
+    return names[static_cast<size_t>(kind)];
+}
+
+NPC::NPC(NPCKind kind, const std::string& name, int x, int y) 
+    : name(&name), x(x), y(y), alive(true), kind(kind) {
+    if (x < MIN_COORD || x > MAX_COORD || y < MIN_COORD || y > MAX_COORD) {
         throw std::invalid_argument("Coordinates must be between 0 and 500");
     }
 }
 
 void NPC::print() const {
-    std::cout << getType() << " '" << name 
+    std::cout << getType() << " '" << *name 
               << "' at (" << x << ", " << y 
               << ") - " << (alive ? "Alive" : "Dead") << std::endl;
 }
 
 void NPC::setPosition(int newX, int newY) {
-    if (newX >= 0 && newX <= 500 && newY >= 0 && newY <= 500) {
+    if (newX >= MIN_COORD && newX <= MAX_COORD && newY >= MIN_COORD && newY <= MAX_COORD) {
         x = newX;
         y = newY;
     }
@@ -30,7 +35,7 @@ double NPC::distanceTo(const NPC& other) const {
 
 std::string NPC::save() const {
     std::ostringstream oss;
-    oss << getType() << "," << name << "," << x << "," << y << "," << alive;
+    oss << getType() << "," << *name << "," << x << "," << y << "," << alive;
     return oss.str();
 }
 
@@ -8,90 +8,59 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <cstdint>
+#include <cstddef>
 
 class NPCVisitor;
 
+enum class NPCKind : uint8_t {
+    Rogue,
+    Orc,
+    Werewolf
+};
+
+constexpr size_t NPC_KIND_COUNT = 3;
+
+const std::string& npcKindName(NPCKind kind);
+
 class NPC {
 protected:
-    std::string name;
+    const std::string* name;
     int x;
     int y;
     bool alive;
+    NPCKind kind;
     
 public:
-    std::string type;
+    static constexpr int MIN_COORD = 0;
+    static constexpr int MAX_COORD = 500;
     
-    NPC(const std::string& name, int x, int y) 
-        : name(name), x(x), y(y), alive(true) {
-        if (x < 0 || x > 500 || y < 0 || y > 500) {
-            throw std::invalid_argument("Coordinates must be between 0 and 500");
-        }
-    }
+    // `name` must outlive the NPC; it normally lives in a NameArena. A
+    // temporary would dangle, so rvalue names are rejected.
+    NPC(NPCKind kind, const std::string& name, int x, int y);
+    NPC(NPCKind kind, std::string&& name, int x, int y) = delete;
     
     virtual ~NPC() = default;
     
     virtual void accept(NPCVisitor& visitor) = 0;
-    virtual std::string getType() const { return type; }
+    NPCKind getKind() const { return kind; }
+    const std::string& getType() const { return npcKindName(kind); }
     
-    virtual void print() const {
-        std::cout << getType() << " '" << name 
-                  << "' at (" << x << ", " << y 
-                  << ") - " << (alive ? "Alive" : "Dead") << std::endl;
-    }
+    virtual void print() const;
     
-    const std::string& getName() const { return name; }
+    const std::string& getName() const { return *name; }
     int getX() const { return x; }
     int getY() const { return y; }
     bool isAlive() const { return alive; }
     
-    void setPosition(int newX, int newY) {
-        if (newX >= 0 && newX <= 500 && newY >= 0 && newY <= 500) {
-            x = newX;
-            y = newY;
-        }
-    }
+    void setPosition(int newX, int newY);
     void die() { alive = false; }
     
-    double distanceTo(const NPC& other) const {
-        int dx = x - other.x;
-        int dy = y - other.y;
-        return std::sqrt(dx*dx + dy*dy);
-    }
+    double distanceTo(const NPC& other) const;
     
-    virtual std::string save() const {
-        std::ostringstream oss;
-        oss << getType() << "," << name << "," << x << "," << y << "," << alive;
-        return oss.str();
-    }
+    virtual std::string save() const;
     
-    static std::shared_ptr<NPC> load(const std::string& data) {
-        std::string type, name;
-        int x, y;
-        bool alive;
-        
-        size_t pos1 = data.find(',');
-        size_t pos2 = data.find(',', pos1 + 1);
-        size_t pos3 = data.find(',', pos2 + 1);
-        size_t pos4 = data.find(',', pos3 + 1);
-        
-        if (pos1 == std::string::npos || pos2 == std::string::npos || 
-            pos3 == std::string::npos || pos4 == std::string::npos) {
-            return nullptr;
-        }
-        
-        type = data.substr(0, pos1);
-        name = data.substr(pos1 + 1, pos2 - pos1 - 1);
-        x = std::stoi(data.substr(pos2 + 1, pos3 - pos2 - 1));
-        y = std::stoi(data.substr(pos3 + 1, pos4 - pos3 - 1));
-        alive = std::stoi(data.substr(pos4 + 1)) != 0;
-        
-        auto npc = std::make_shared<NPC>(name, x, y);
-        npc->type = type;
-        if (!alive) {
-            npc->die();
-        }
-        return npc;
-    }
+    static std::shared_ptr<NPC> load(const std::string& data);
 };
 
 #endif
\ No newline at end of file
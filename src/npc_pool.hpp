@@ -0,0 +1,142 @@
+#ifndef NPC_POOL_HPP
+#define NPC_POOL_HPP
+
+#include "npc.hpp"
+#include "rogue.hpp"
+#include "orc.hpp"
+#include "werewolf.hpp"
+#include "name_arena.hpp"
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+struct NPCSeed {
+    NPCKind kind;
+    const std::string* name;
+    int x;
+    int y;
+    bool alive;
+};
+
+// Fixed-capacity block of one concrete NPC type. Handed-out shared_ptrs alias
+// the slab's control block, so a slab is freed in one go once the last NPC in
+// it is released. It also keeps the names its NPCs point at alive.
+template <typename T>
+class NPCSlab {
+private:
+    std::shared_ptr<NameArena> names;
+    T* objects;
+    size_t capacity;
+    size_t used = 0;
+
+public:
+    NPCSlab(size_t capacity, std::shared_ptr<NameArena> names)
+        : names(std::move(names)), objects(std::allocator<T>().allocate(capacity)), capacity(capacity) {}
+
+    NPCSlab(const NPCSlab&) = delete;
+    NPCSlab& operator=(const NPCSlab&) = delete;
+
+    ~NPCSlab() {
+        for (size_t i = 0; i < used; i++) objects[i].~T();
+        std::allocator<T>().deallocate(objects, capacity);
+    }
+
+    size_t room() const { return capacity - used; }
+
+    T* emplace(const std::string& name, int x, int y) {
+        T* npc = new (objects + used) T(name, x, y);
+        used++;
+        return npc;
+    }
+};
+
+// Per-world NPC allocator: one open slab per kind, names stored in a shared
+// NameArena. Not thread-safe; parallel builders use one pool each over the
+// same arena.
+class NPCPool {
+public:
+    static constexpr size_t SLAB_CAPACITY = 1024;
+
+private:
+    std::shared_ptr<NameArena> names;
+    std::shared_ptr<NPCSlab<Rogue>> rogues;
+    std::shared_ptr<NPCSlab<Orc>> orcs;
+    std::shared_ptr<NPCSlab<Werewolf>> werewolves;
+    size_t slabCount = 0;
+
+    template <typename T>
+    void ensureRoom(std::shared_ptr<NPCSlab<T>>& slab, size_t count) {
+        if (slab && slab->room() >= count) return;
+        slab = std::make_shared<NPCSlab<T>>(std::max(SLAB_CAPACITY, count), names);
+        slabCount++;
+    }
+
+    template <typename T>
+    static std::shared_ptr<NPC> single(std::string_view name, int x, int y) {
+        auto arena = std::make_shared<NameArena>();
+        const std::string& stored = arena->store(name);
+        auto slab = std::make_shared<NPCSlab<T>>(1, std::move(arena));
+        return std::shared_ptr<NPC>(slab, slab->emplace(stored, x, y));
+    }
+    
+    template <typename T>
+    std::shared_ptr<NPC> emplace(std::shared_ptr<NPCSlab<T>>& slab, const std::string& name, int x, int y) {
+        ensureRoom(slab, 1);
+        return std::shared_ptr<NPC>(slab, slab->emplace(name, x, y));
+    }
+
+public:
+    explicit NPCPool(std::shared_ptr<NameArena> names = std::make_shared<NameArena>())
+        : names(std::move(names)) {}
+
+    NPCPool(const NPCPool&) = delete;
+    NPCPool& operator=(const NPCPool&) = delete;
+
+    NameArena& getNames() { return *names; }
+    const std::shared_ptr<NameArena>& shareNames() const { return names; }
+    size_t getSlabCount() const { return slabCount; }
+
+    // `name` must already live in this pool's arena.
+    std::shared_ptr<NPC> create(NPCKind kind, const std::string& name, int x, int y) {
+        switch (kind) {
+            case NPCKind::Rogue: return emplace(rogues, name, x, y);
+            case NPCKind::Orc: return emplace(orcs, name, x, y);
+            case NPCKind::Werewolf: return emplace(werewolves, name, x, y);
+        }
+        throw std::invalid_argument("Unknown NPC kind");
+    }
+
+    // For NPCs that belong to no world: a one-object slab with its own arena,
+    // so the NPC and its name are freed together.
+    static std::shared_ptr<NPC> createStandalone(NPCKind kind, std::string_view name, int x, int y) {
+        switch (kind) {
+            case NPCKind::Rogue: return single<Rogue>(name, x, y);
+            case NPCKind::Orc: return single<Orc>(name, x, y);
+            case NPCKind::Werewolf: return single<Werewolf>(name, x, y);
+        }
+        throw std::invalid_argument("Unknown NPC kind");
+    }
+    
+    // Sizes each kind's slab for the whole batch up front, so a batch lands
+    // in at most one new slab per kind.
+    void createBatch(const NPCSeed* seeds, size_t count, std::shared_ptr<NPC>* out) {
+        size_t perKind[NPC_KIND_COUNT] = {};
+        for (size_t i = 0; i < count; i++) perKind[static_cast<size_t>(seeds[i].kind)]++;
+        if (perKind[0]) ensureRoom(rogues, perKind[0]);
+        if (perKind[1]) ensureRoom(orcs, perKind[1]);
+        if (perKind[2]) ensureRoom(werewolves, perKind[2]);
+
+        for (size_t i = 0; i < count; i++) {
+            const NPCSeed& seed = seeds[i];
+            out[i] = create(seed.kind, *seed.name, seed.x, seed.y);
+            if (!seed.alive) out[i]->die();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef NPC_TYPES_HPP
+#define NPC_TYPES_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#define NPC_KILLS(type) (1u << static_cast<unsigned>(NPCType::type))
+
+// X(type, plural, glyph, move distance, kill distance, victims)
+#define NPC_TYPE_LIST(X) \
+    X(Rogue,    "Rogues",     'R', 10, 10, NPC_KILLS(Werewolf)) \
+    X(Orc,      "Orcs",       'O', 20, 10, NPC_KILLS(Rogue))    \
+    X(Werewolf, "Werewolves", 'W', 40,  5, NPC_KILLS(Rogue))    \
+    X(Pegasus,  "Pegasus",    'P', 30, 10, 0u)
+
+enum class NPCType : uint8_t {
+#define NPC_TYPE_ENUM(type, plural, glyph, move, kill, victims) type,
+    NPC_TYPE_LIST(NPC_TYPE_ENUM)
+#undef NPC_TYPE_ENUM
+    None
+};
+
+constexpr size_t NPC_TYPE_COUNT = static_cast<size_t>(NPCType::None);
+
+struct NPCTypeInfo {
+    const char* name;
+    const char* plural;
+    char glyph;
+    int move_distance;
+    int kill_distance;
+    uint32_t victims;
+};
+
+constexpr NPCTypeInfo NPC_TYPE_INFO[NPC_TYPE_COUNT] = {
+#define NPC_TYPE_INFO_ROW(type, plural, glyph, move, kill, victims) \
+    {#type, plural, glyph, move, kill, victims},
+    NPC_TYPE_LIST(NPC_TYPE_INFO_ROW)
+#undef NPC_TYPE_INFO_ROW
+};
+
+constexpr size_t npc_type_index(NPCType type) {
+    return static_cast<size_t>(type);
+}
+
+constexpr NPCType npc_type_at(size_t index) {
+    return static_cast<NPCType>(index);
+}
+
+constexpr bool npc_type_valid(NPCType type) {
+    return npc_type_index(type) < NPC_TYPE_COUNT;
+}
+
+constexpr int npc_move_distance(NPCType type) {
+    return npc_type_valid(type) ? NPC_TYPE_INFO[npc_type_index(type)].move_distance : 0;
+}
+
+constexpr int npc_kill_distance(NPCType type) {
+    return npc_type_valid(type) ? NPC_TYPE_INFO[npc_type_index(type)].kill_distance : 0;
+}
+
+constexpr char npc_glyph(NPCType type) {
+    return npc_type_valid(type) ? NPC_TYPE_INFO[npc_type_index(type)].glyph : '.';
+}
+
+constexpr bool npc_can_kill(NPCType attacker, NPCType defender) {
+    return npc_type_valid(attacker) && npc_type_valid(defender) &&
+           (NPC_TYPE_INFO[npc_type_index(attacker)].victims & (1u << npc_type_index(defender))) != 0;
+}
+
+constexpr int npc_max_kill_distance() {
+    int result = 1;
+    for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) {
+        if (NPC_TYPE_INFO[i].kill_distance > result) result = NPC_TYPE_INFO[i].kill_distance;
+    }
+    return result;
+}
+
+inline const std::string& npc_type_name(NPCType type) {
+    static const std::string names[NPC_TYPE_COUNT + 1] = {
+#define NPC_TYPE_NAME(type, plural, glyph, move, kill, victims) #type,
+        NPC_TYPE_LIST(NPC_TYPE_NAME)
+#undef NPC_TYPE_NAME
+        ""
+    };
+    return names[npc_type_valid(type) ? npc_type_index(type) : NPC_TYPE_COUNT];
+}
+
+inline NPCType parse_npc_type(const std::string& name) {
+    for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) {
+        if (name == NPC_TYPE_INFO[i].name) return npc_type_at(i);
+    }
+    return NPCType::None;
+}
+
+static_assert(NPC_TYPE_COUNT <= 32, "Kill masks hold at most 32 NPC types");
+static_assert(npc_can_kill(NPCType::Rogue, NPCType::Werewolf), "Rogue kills Werewolves");
+static_assert(!npc_can_kill(NPCType::Pegasus, NPCType::Rogue), "Pegasus doesn't kill anyone");
+
+#endif
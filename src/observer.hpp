@@ -1,69 +1,332 @@
 #ifndef OBSERVER_HPP
 #define OBSERVER_HPP
 
+#include "npc.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
 
+enum class EventKind : uint8_t {
+    NPCAdded,
+    NPCMoved,
+    BatchAdded,
+    Saved,
+    Loaded,
+    Cleared,
+    Recovered,
+    BattleStarted,
+    Kill,
+    BattleFinished,
+    LoadProblem,
+    Failure
+};
+
+enum class EventLevel : uint8_t {
+    Debug,
+    Info,
+    Warning
+};
+
+constexpr EventLevel eventLevel(EventKind kind) {
+    return kind == EventKind::Kill ? EventLevel::Debug
+         : kind == EventKind::LoadProblem || kind == EventKind::Failure ? EventLevel::Warning
+         : EventLevel::Info;
+}
+
+// Raw event data; nothing is formatted until a sink calls renderEvent. NPCs are
+// held by shared_ptr so their names stay valid for asynchronous delivery.
+struct Event {
+    EventKind kind;
+    std::shared_ptr<const NPC> subject = nullptr;
+    std::shared_ptr<const NPC> target = nullptr;
+    int x = 0;
+    int y = 0;
+    size_t count = 0;
+    size_t extra = 0;
+    double range = 0.0;
+    std::string source = {};
+    std::string text = {};
+};
+
+inline void renderEvent(const Event& event, std::string& out) {
+    auto npcLabel = [&](const NPC& npc) {
+        out += npc.getType();
+        out += " '";
+        out += npc.getName();
+        out += "'";
+    };
+    auto position = [&]() {
+        out += "(" + std::to_string(event.x) + ", " + std::to_string(event.y) + ")";
+    };
+
+    switch (event.kind) {
+        case EventKind::NPCAdded:
+            out += "Added ";
+            npcLabel(*event.subject);
+            out += " at ";
+            position();
+            break;
+        case EventKind::NPCMoved:
+            out += "Moved '" + event.subject->getName() + "' to ";
+            position();
+            break;
+        case EventKind::BatchAdded:
+            out += "Added " + std::to_string(event.count) + " NPCs";
+            break;
+        case EventKind::Saved:
+            out += "Saved " + std::to_string(event.count) + " NPCs to " + event.source;
+            break;
+        case EventKind::Loaded:
+            out += "Loaded " + std::to_string(event.count) + " NPCs from " + event.source;
+            if (event.extra) out += " (" + std::to_string(event.extra) + " lines skipped)";
+            break;
+        case EventKind::Cleared:
+            out += "Dungeon cleared. Removed " + std::to_string(event.count) + " NPCs";
+            break;
+        case EventKind::Recovered:
+            out += "Recovered " + std::to_string(event.count) + " NPCs from " + event.source +
+                   " (" + std::to_string(event.extra) + " journal entries replayed)";
+            break;
+        case EventKind::BattleStarted:
+            out += "Starting battle simulation with range " + std::to_string(event.range);
+            break;
+        case EventKind::Kill:
+            npcLabel(*event.subject);
+            out += " defeated ";
+            npcLabel(*event.target);
+            break;
+        case EventKind::BattleFinished:
+            out += "Battle finished. Removed " + std::to_string(event.count) + " dead NPCs";
+            break;
+        case EventKind::LoadProblem:
+            out += event.source + ":" + std::to_string(event.count) + ": " + event.text;
+            break;
+        case EventKind::Failure:
+            out += event.text;
+            break;
+    }
+}
+
+inline std::string renderEvent(const Event& event) {
+    std::string out;
+    renderEvent(event, out);
+    return out;
+}
+
+// The filter is atomic so that subscribe() and setMinLevel() may run while the
+// dispatcher thread is checking wants().
 class Observer {
+private:
+    std::atomic<uint32_t> kindMask{~0u};
+    std::atomic<EventLevel> minLevel{EventLevel::Debug};
+
 public:
     virtual ~Observer() = default;
-    virtual void update(const std::string& message) = 0;
+    virtual void update(const Event& event) = 0;
+
+    // Called by asynchronous dispatch with every event queued since the last
+    // batch, in order; events this observer does not want must be skipped.
+    virtual void updateBatch(const std::vector<Event>& events) {
+        for (const auto& event : events) {
+            if (wants(event.kind)) update(event);
+        }
+    }
+
+    void subscribe(EventKind kind, bool enabled = true) {
+        uint32_t bit = 1u << static_cast<uint32_t>(kind);
+        if (enabled) {
+            kindMask.fetch_or(bit);
+        } else {
+            kindMask.fetch_and(~bit);
+        }
+    }
+
+    void setMinLevel(EventLevel level) { minLevel = level; }
+
+    bool wants(EventKind kind) const {
+        return (kindMask >> static_cast<uint32_t>(kind) & 1u) && eventLevel(kind) >= minLevel;
+    }
 };
 
-class ConsoleObserver : public Observer {
+// Base for sinks that write rendered lines to a stream.
+class TextObserver : public Observer {
+private:
+    std::string buffer;
+
+protected:
+    virtual std::ostream* stream() = 0;
+
 public:
-    void update(const std::string& message) override {
-        std::cout << "[EVENT] " << message << std::endl;
+    void update(const Event& event) override {
+        std::ostream* out = stream();
+        if (!out) return;
+        buffer = "[EVENT] ";
+        renderEvent(event, buffer);
+        *out << buffer << std::endl;
     }
+
+    void updateBatch(const std::vector<Event>& events) override {
+        std::ostream* out = stream();
+        if (!out) return;
+        buffer.clear();
+        for (const auto& event : events) {
+            if (!wants(event.kind)) continue;
+            buffer += "[EVENT] ";
+            renderEvent(event, buffer);
+            buffer += '\n';
+        }
+        out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out->flush();
+    }
+};
+
+class ConsoleObserver : public TextObserver {
+protected:
+    std::ostream* stream() override { return &std::cout; }
 };
 
-class FileObserver : public Observer {
+class FileObserver : public TextObserver {
 private:
     std::ofstream logFile;
-    
+
+protected:
+    std::ostream* stream() override { return logFile.is_open() ? &logFile : nullptr; }
+
 public:
     FileObserver(const std::string& filename) {
         logFile.open(filename, std::ios::app);
     }
-    
+
     ~FileObserver() {
         if (logFile.is_open()) {
             logFile.close();
         }
     }
-    
-    void update(const std::string& message) override {
-        if (logFile.is_open()) {
-            logFile << "[EVENT] " << message << std::endl;
-        }
-    }
 };
 
+// Synchronous by default. With setAsync(true), notify() only queues the
+// event and a dispatcher thread hands queued events to every observer in
+// batches; flush() waits until everything queued so far has been delivered.
+// Emitters check wants() first so that unobserved events are never built.
 class Observable {
 private:
     std::vector<Observer*> observers;
-    
+    mutable std::mutex observersMutex;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::condition_variable drainedCv;
+    std::vector<Event> pending;
+    uint64_t queued = 0;
+    uint64_t delivered = 0;
+    bool stopping = false;
+    bool async = false;
+    std::thread dispatcher;
+
+    void dispatchLoop() {
+        std::vector<Event> batch;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            while (!queueCv.wait_for(lock, std::chrono::milliseconds(100),
+                                     [this]() { return !pending.empty() || stopping; })) {}
+            if (pending.empty()) return;
+
+            batch.swap(pending);
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> guard(observersMutex);
+                for (auto observer : observers) observer->updateBatch(batch);
+            }
+            lock.lock();
+            delivered += batch.size();
+            batch.clear();
+            drainedCv.notify_all();
+        }
+    }
+
 public:
+    Observable() = default;
+    Observable(const Observable&) = delete;
+    Observable& operator=(const Observable&) = delete;
+
     void attach(Observer* observer) {
+        std::lock_guard<std::mutex> guard(observersMutex);
         observers.push_back(observer);
     }
-    
+
+    // Events queued before the call still reach the observer.
     void detach(Observer* observer) {
-        observers.erase(std::remove(observers.begin(), observers.end(), observer), 
+        flush();
+        std::lock_guard<std::mutex> guard(observersMutex);
+        observers.erase(std::remove(observers.begin(), observers.end(), observer),
                        observers.end());
     }
-    
-    void notify(const std::string& message) {
+
+    bool wants(EventKind kind) const {
+        std::lock_guard<std::mutex> guard(observersMutex);
         for (auto observer : observers) {
-            observer->update(message);
+            if (observer->wants(kind)) return true;
         }
+        return false;
+    }
+
+    void notify(Event event) {
+        if (!async) {
+            std::lock_guard<std::mutex> guard(observersMutex);
+            for (auto observer : observers) {
+                if (observer->wants(event.kind)) observer->update(event);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pending.push_back(std::move(event));
+            queued++;
+        }
+        queueCv.notify_one();
+    }
+
+    void setAsync(bool enabled) {
+        if (enabled == async) return;
+        if (enabled) {
+            stopping = false;
+            async = true;
+            dispatcher = std::thread(&Observable::dispatchLoop, this);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCv.notify_one();
+        dispatcher.join();
+        async = false;
+    }
+
+    bool isAsync() const { return async; }
+
+    void flush() {
+        if (!async) return;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        uint64_t target = queued;
+        while (!drainedCv.wait_for(lock, std::chrono::milliseconds(100),
+                                   [&]() { return delivered >= target; })) {}
+    }
+
+    virtual ~Observable() {
+        setAsync(false);
     }
-    
-    virtual ~Observable() = default;
 };
 
-#endif
\ No newline at end of file
+#endif
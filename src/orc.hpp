@@ -6,9 +6,9 @@
 class Orc : public NPC {
 public:
     Orc(const std::string& name, int x, int y);
+    Orc(std::string&& name, int x, int y) = delete;
     
     void accept(NPCVisitor& visitor) override;
-    std::string getType() const override { return "Orc"; }
 };
 
 #endif
\ No newline at end of file
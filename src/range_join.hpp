@@ -0,0 +1,102 @@
+#ifndef RANGE_JOIN_HPP
+#define RANGE_JOIN_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <numeric>
+#include <algorithm>
+
+// Sweep-and-prune self join over integer points. Points are sorted by x (then
+// y), and each point is compared only with the following x columns inside the
+// range window, narrowed to the y window by binary search.
+class RangeJoin {
+private:
+    long long limit;
+    long long window;
+    std::vector<uint32_t> order;
+    std::vector<int> sortedY;
+    std::vector<int> columnX;
+    std::vector<size_t> columnStart;
+
+public:
+    explicit RangeJoin(double range) : limit(squaredLimit(range)), window(-1) {
+        if (limit < 0) return;
+        window = static_cast<long long>(std::sqrt(static_cast<double>(limit)));
+        while (window > 0 && window * window > limit) window--;
+        while ((window + 1) * (window + 1) <= limit) window++;
+    }
+
+    // Largest integer d2 with sqrt(d2) <= range, so integer comparisons give
+    // exactly the same answer as comparing the floating-point distance.
+    static long long squaredLimit(double range) {
+        if (!(range >= 0)) return -1;
+        if (range >= 3.0e9) return static_cast<long long>(9.0e18);
+        long long d2 = static_cast<long long>(range * range);
+        while (std::sqrt(static_cast<double>(d2 + 1)) <= range) d2++;
+        while (d2 >= 0 && std::sqrt(static_cast<double>(d2)) > range) d2--;
+        return d2;
+    }
+
+    long long getSquaredLimit() const { return limit; }
+
+    // Calls fn(a, b) once for every unordered pair within range, with a < b.
+    template <typename Fn>
+    void forEachPair(const std::vector<int>& xs, const std::vector<int>& ys, Fn&& fn) {
+        if (limit < 0) return;
+        size_t count = xs.size();
+
+        order.resize(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return xs[a] != xs[b] ? xs[a] < xs[b] : ys[a] < ys[b];
+        });
+
+        sortedY.resize(count);
+        columnX.clear();
+        columnStart.clear();
+        for (size_t k = 0; k < count; ++k) {
+            int x = xs[order[k]];
+            if (columnX.empty() || columnX.back() != x) {
+                columnX.push_back(x);
+                columnStart.push_back(k);
+            }
+            sortedY[k] = ys[order[k]];
+        }
+        columnStart.push_back(count);
+
+        auto emit = [&](size_t i, size_t k) {
+            uint32_t a = order[i];
+            uint32_t b = order[k];
+            if (a < b) fn(a, b);
+            else fn(b, a);
+        };
+
+        size_t columns = columnX.size();
+        for (size_t c = 0; c < columns; ++c) {
+            long long xi = columnX[c];
+            for (size_t i = columnStart[c]; i < columnStart[c + 1]; ++i) {
+                long long yi = sortedY[i];
+
+                for (size_t k = i + 1; k < columnStart[c + 1] && sortedY[k] - yi <= window; ++k) {
+                    long long dy = sortedY[k] - yi;
+                    if (dy * dy <= limit) emit(i, k);
+                }
+
+                for (size_t next = c + 1; next < columns && columnX[next] - xi <= window; ++next) {
+                    long long dx = columnX[next] - xi;
+                    auto first = sortedY.begin() + columnStart[next];
+                    auto last = sortedY.begin() + columnStart[next + 1];
+                    auto it = std::lower_bound(first, last, yi - window);
+                    for (; it != last && *it - yi <= window; ++it) {
+                        long long dy = *it - yi;
+                        if (dx * dx + dy * dy <= limit) emit(i, static_cast<size_t>(it - sortedY.begin()));
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif
@@ -2,7 +2,7 @@
 #include "visitor_simulate_fight.hpp"
 
 Rogue::Rogue(const std::string& name, int x, int y) 
-    : NPC(name, x, y) {}
+    : NPC(NPCKind::Rogue, name, x, y) {}
 
 void Rogue::accept(NPCVisitor& visitor) {
     visitor.visit(*this);
@@ -6,9 +6,9 @@
 class Rogue : public NPC {
 public:
     Rogue(const std::string& name, int x, int y);
+    Rogue(std::string&& name, int x, int y) = delete;
     
     void accept(NPCVisitor& visitor) override;
-    std::string getType() const override { return "Rogue"; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#ifndef SHARD_CHANNEL_HPP
+#define SHARD_CHANNEL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// Length-prefixed frames of trivially copyable records over a connected Unix
+// domain socket. Both ends run on the same machine, so records travel in host
+// byte order and layout.
+namespace shard {
+
+enum class Frame : uint32_t {
+    Init = 1,
+    Tick,
+    Handoff,
+    Ghosts,
+    Report,
+    Battles,
+    Deaths,
+    Collect,
+    State,
+    Stop
+};
+
+struct Header {
+    uint32_t frame;
+    uint32_t bytes;
+};
+
+inline bool write_all(int fd, const void* data, size_t bytes) {
+    const char* cursor = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = ::send(fd, cursor, bytes, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        cursor += written;
+        bytes -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+inline bool read_all(int fd, void* data, size_t bytes) {
+    char* cursor = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t got = ::recv(fd, cursor, bytes, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        cursor += got;
+        bytes -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+template <typename T>
+std::string encode(Frame frame, const std::vector<T>& records) {
+    static_assert(std::is_trivially_copyable<T>::value, "records are sent as raw bytes");
+    Header header{static_cast<uint32_t>(frame), static_cast<uint32_t>(records.size() * sizeof(T))};
+    std::string out(sizeof(header) + header.bytes, '\0');
+    std::memcpy(&out[0], &header, sizeof(header));
+    if (header.bytes) std::memcpy(&out[sizeof(header)], records.data(), header.bytes);
+    return out;
+}
+
+template <typename T>
+bool decode(const Header& header, Frame expected, const std::string& payload, std::vector<T>& records) {
+    if (header.frame != static_cast<uint32_t>(expected) || header.bytes % sizeof(T) != 0) return false;
+    records.resize(header.bytes / sizeof(T));
+    if (header.bytes) std::memcpy(records.data(), payload.data(), header.bytes);
+    return true;
+}
+
+template <typename T>
+bool send(int fd, Frame frame, const std::vector<T>& records) {
+    std::string out = encode(frame, records);
+    return write_all(fd, out.data(), out.size());
+}
+
+// Returns false on a closed socket or when the next frame is not `expected`.
+template <typename T>
+bool receive(int fd, Frame expected, std::vector<T>& records) {
+    Header header;
+    if (!read_all(fd, &header, sizeof(header))) return false;
+    std::string payload(header.bytes, '\0');
+    if (header.bytes && !read_all(fd, &payload[0], header.bytes)) return false;
+    return decode(header, expected, payload, records);
+}
+
+// Sends outgoing[i] to fds[i] while receiving incoming[i] from it, for all
+// peers at once. Every peer does the same, so a blocking send-then-receive
+// could deadlock once frames outgrow the socket buffers.
+template <typename T>
+bool exchange(const std::vector<int>& fds, Frame frame,
+              const std::vector<std::vector<T>>& outgoing, std::vector<std::vector<T>>& incoming) {
+    struct Peer {
+        std::string out;
+        size_t sent = 0;
+        Header header{};
+        size_t header_read = 0;
+        std::string payload;
+        size_t payload_read = 0;
+        bool received = false;
+    };
+
+    std::vector<Peer> peers(fds.size());
+    for (size_t i = 0; i < fds.size(); ++i) peers[i].out = encode(frame, outgoing[i]);
+    incoming.assign(fds.size(), {});
+
+    std::vector<pollfd> polls(fds.size());
+    while (true) {
+        size_t active = 0;
+        for (size_t i = 0; i < fds.size(); ++i) {
+            short events = 0;
+            if (peers[i].sent < peers[i].out.size()) events |= POLLOUT;
+            if (!peers[i].received) events |= POLLIN;
+            polls[i] = {events ? fds[i] : -1, events, 0};
+            if (events) active++;
+        }
+        if (active == 0) break;
+
+        if (::poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        for (size_t i = 0; i < fds.size(); ++i) {
+            Peer& peer = peers[i];
+            if (polls[i].revents & POLLOUT) {
+                ssize_t written = ::send(fds[i], peer.out.data() + peer.sent, peer.out.size() - peer.sent,
+                                         MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (written < 0 && errno != EAGAIN && errno != EINTR) return false;
+                if (written > 0) peer.sent += static_cast<size_t>(written);
+            }
+            if (!(polls[i].revents & (POLLIN | POLLHUP | POLLERR)) || peer.received) continue;
+
+            char* target;
+            size_t wanted;
+            if (peer.header_read < sizeof(Header)) {
+                target = reinterpret_cast<char*>(&peer.header) + peer.header_read;
+                wanted = sizeof(Header) - peer.header_read;
+            } else {
+                target = &peer.payload[peer.payload_read];
+                wanted = peer.payload.size() - peer.payload_read;
+            }
+            ssize_t got = ::recv(fds[i], target, wanted, MSG_DONTWAIT);
+            if (got == 0) return false;
+            if (got < 0) {
+                if (errno == EAGAIN || errno == EINTR) continue;
+                return false;
+            }
+
+            if (peer.header_read < sizeof(Header)) {
+                peer.header_read += static_cast<size_t>(got);
+                if (peer.header_read == sizeof(Header)) peer.payload.assign(peer.header.bytes, '\0');
+            } else {
+                peer.payload_read += static_cast<size_t>(got);
+            }
+            if (peer.header_read == sizeof(Header) && peer.payload_read == peer.payload.size()) {
+                if (!decode(peer.header, frame, peer.payload, incoming[i])) return false;
+                peer.received = true;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+#endif
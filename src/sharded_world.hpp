@@ -0,0 +1,438 @@
+#ifndef SHARDED_WORLD_HPP
+#define SHARDED_WORLD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "async_game.hpp"
+#include "counter_rng.hpp"
+#include "npc_types.hpp"
+#include "shard_channel.hpp"
+#include "spatial_grid.hpp"
+
+struct ShardNPC {
+    uint32_t id;
+    int32_t x;
+    int32_t y;
+    NPCType type;
+    uint8_t alive;
+};
+
+struct ShardBattle {
+    uint32_t attacker;
+    uint32_t defender;
+    uint32_t kills;
+};
+
+// One column strip [x_begin, x_end) of the map, run in its own process.
+// Every tick it moves the NPCs it owns, hands off those that left the strip,
+// swaps ghost copies of NPCs within kill range of a border with its
+// neighbours, and reports every battle its own NPCs start. Battles are only
+// collected here; the coordinator resolves them all in the single-process
+// order and sends back the deaths.
+class ShardWorker {
+private:
+    uint64_t seed;
+    int width;
+    int height;
+    int x_begin;
+    int x_end;
+    int halo;
+    int coordinator;
+    std::vector<int> neighbours;
+    std::vector<int> neighbour_side;
+
+    std::vector<ShardNPC> owned;
+    std::vector<ShardNPC> ghosts;
+    SpatialGrid grid;
+    uint64_t tick = 0;
+
+    void move_owned() {
+        for (auto& npc : owned) {
+            if (!npc.alive || !npc_type_valid(npc.type)) continue;
+            int move_dist = npc_move_distance(npc.type);
+
+            CounterRng rng(seed, CounterRng::Movement, tick, npc.id);
+            int dx = rng.uniform(-1, 1);
+            int dy = rng.uniform(-1, 1);
+            npc.x = std::max(0, std::min(width - 1, npc.x + dx * move_dist));
+            npc.y = std::max(0, std::min(height - 1, npc.y + dy * move_dist));
+        }
+    }
+
+    // Strip widths are at least the largest move, so a mover only ever lands
+    // in a direct neighbour.
+    bool hand_off(uint32_t& handed_off) {
+        std::vector<std::vector<ShardNPC>> outgoing(neighbours.size()), incoming;
+        std::vector<ShardNPC> staying;
+        for (const auto& npc : owned) {
+            int side = npc.x < x_begin ? -1 : npc.x >= x_end ? 1 : 0;
+            if (side == 0) {
+                staying.push_back(npc);
+                continue;
+            }
+            for (size_t n = 0; n < neighbours.size(); ++n) {
+                if (neighbour_side[n] == side) outgoing[n].push_back(npc);
+            }
+        }
+        if (!shard::exchange(neighbours, shard::Frame::Handoff, outgoing, incoming)) return false;
+
+        handed_off = static_cast<uint32_t>(owned.size() - staying.size());
+        owned.swap(staying);
+        for (const auto& arrived : incoming) owned.insert(owned.end(), arrived.begin(), arrived.end());
+        return true;
+    }
+
+    bool swap_ghosts() {
+        std::vector<std::vector<ShardNPC>> outgoing(neighbours.size());
+        for (const auto& npc : owned) {
+            if (!npc.alive) continue;
+            for (size_t n = 0; n < neighbours.size(); ++n) {
+                bool near = neighbour_side[n] < 0 ? npc.x < x_begin + halo : npc.x >= x_end - halo;
+                if (near) outgoing[n].push_back(npc);
+            }
+        }
+
+        std::vector<std::vector<ShardNPC>> incoming;
+        if (!shard::exchange(neighbours, shard::Frame::Ghosts, outgoing, incoming)) return false;
+        ghosts.clear();
+        for (const auto& copies : incoming) ghosts.insert(ghosts.end(), copies.begin(), copies.end());
+        return true;
+    }
+
+    // Same neighbourhood test as AsyncGame::collect_targets, over owned NPCs
+    // and ghosts; local index i < owned.size() is owned, the rest are ghosts.
+    std::vector<ShardBattle> collect_battles() {
+        auto local = [&](size_t i) -> const ShardNPC& {
+            return i < owned.size() ? owned[i] : ghosts[i - owned.size()];
+        };
+        size_t total = owned.size() + ghosts.size();
+
+        grid.clear();
+        for (size_t i = 0; i < total; ++i) {
+            if (local(i).alive) grid.insert(i, local(i).x, local(i).y);
+        }
+
+        std::vector<ShardBattle> battles;
+        for (size_t i = 0; i < owned.size(); ++i) {
+            const ShardNPC& npc = owned[i];
+            if (!npc.alive || !npc_type_valid(npc.type)) continue;
+            int kill_dist = npc_kill_distance(npc.type);
+
+            grid.for_each_near(npc.x, npc.y, kill_dist, [&](size_t other_index) {
+                const ShardNPC& other = local(other_index);
+                if (other.id == npc.id || !npc_can_kill(npc.type, other.type)) return;
+                int dx = npc.x - other.x;
+                int dy = npc.y - other.y;
+                if (std::sqrt(dx*dx + dy*dy) > kill_dist) return;
+
+                CounterRng rng(seed, CounterRng::Battle, tick, npc.id, other.id);
+                int attack_power = rng.uniform(1, 6);
+                int defense_power = rng.uniform(1, 6);
+                battles.push_back({npc.id, other.id, attack_power > defense_power ? 1u : 0u});
+            });
+        }
+        return battles;
+    }
+
+    bool run_tick() {
+        move_owned();
+        uint32_t handed_off = 0;
+        if (!hand_off(handed_off) || !swap_ghosts()) return false;
+
+        std::vector<uint32_t> report = {handed_off, static_cast<uint32_t>(ghosts.size())};
+        if (!shard::send(coordinator, shard::Frame::Report, report)) return false;
+        if (!shard::send(coordinator, shard::Frame::Battles, collect_battles())) return false;
+
+        std::vector<uint32_t> deaths;
+        if (!shard::receive(coordinator, shard::Frame::Deaths, deaths)) return false;
+        std::sort(deaths.begin(), deaths.end());
+        for (auto& npc : owned) {
+            if (std::binary_search(deaths.begin(), deaths.end(), npc.id)) npc.alive = 0;
+        }
+        tick++;
+        return true;
+    }
+
+public:
+    ShardWorker(uint64_t seed, int width, int height, int x_begin, int x_end, int halo, int coordinator,
+                std::vector<int> neighbours, std::vector<int> neighbour_side)
+        : seed(seed), width(width), height(height), x_begin(x_begin), x_end(x_end), halo(halo),
+          coordinator(coordinator), neighbours(std::move(neighbours)),
+          neighbour_side(std::move(neighbour_side)), grid(width, height, npc_max_kill_distance()) {}
+
+    // Serves the coordinator until it sends Stop or goes away.
+    bool run() {
+        if (!shard::receive(coordinator, shard::Frame::Init, owned)) return false;
+
+        while (true) {
+            shard::Header header;
+            if (!shard::read_all(coordinator, &header, sizeof(header)) || header.bytes != 0) return false;
+
+            switch (static_cast<shard::Frame>(header.frame)) {
+                case shard::Frame::Tick:
+                    if (!run_tick()) return false;
+                    break;
+                case shard::Frame::Collect:
+                    if (!shard::send(coordinator, shard::Frame::State, owned)) return false;
+                    break;
+                case shard::Frame::Stop:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+    }
+};
+
+// Coordinator for a world split into vertical strips, one forked ShardWorker
+// process per strip. Shards talk to their neighbours and to the coordinator
+// over socketpairs. Ticks run in lockstep; battles reported by all shards are
+// merged, sorted by (attacker, defender) and fought in that order, so the run
+// matches AsyncGame::step() for the same seed.
+class ShardedWorld {
+private:
+    struct Shard {
+        pid_t pid = -1;
+        int fd = -1;
+    };
+
+    int map_size;
+    int npc_count;
+    std::vector<Shard> shards;
+    std::vector<uint8_t> alive;
+    uint64_t tick = 0;
+    size_t battles_resolved = 0;
+    size_t handoffs = 0;
+    size_t ghosts = 0;
+
+    static int strip_begin(int shard, int shard_count, int map_size) {
+        return static_cast<int>(static_cast<int64_t>(shard) * map_size / shard_count);
+    }
+
+    void fail(size_t shard) {
+        throw std::runtime_error("Shard " + std::to_string(shard) + " stopped responding");
+    }
+
+    void launch(uint64_t seed, const std::vector<std::vector<ShardNPC>>& initial) {
+        int shard_count = static_cast<int>(initial.size());
+        std::vector<std::array<int, 2>> coordinator_links(shard_count), neighbour_links(shard_count - 1);
+        std::vector<int> all_fds;
+        auto open_pair = [&](std::array<int, 2>& link) {
+            int fds[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                for (int fd : all_fds) ::close(fd);
+                throw std::runtime_error("socketpair failed");
+            }
+            link = {fds[0], fds[1]};
+            all_fds.push_back(fds[0]);
+            all_fds.push_back(fds[1]);
+        };
+        for (auto& link : coordinator_links) open_pair(link);
+        for (auto& link : neighbour_links) open_pair(link);
+
+        int halo = npc_max_kill_distance();
+        shards.resize(shard_count);
+        for (int s = 0; s < shard_count; ++s) {
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                for (int fd : all_fds) ::close(fd);
+                throw std::runtime_error("fork failed");
+            }
+            if (pid > 0) {
+                shards[s] = {pid, coordinator_links[s][0]};
+                continue;
+            }
+
+            std::vector<int> neighbours, sides, keep = {coordinator_links[s][1]};
+            if (s > 0) {
+                neighbours.push_back(neighbour_links[s - 1][1]);
+                sides.push_back(-1);
+            }
+            if (s + 1 < shard_count) {
+                neighbours.push_back(neighbour_links[s][0]);
+                sides.push_back(1);
+            }
+            keep.insert(keep.end(), neighbours.begin(), neighbours.end());
+            for (int fd : all_fds) {
+                if (std::find(keep.begin(), keep.end(), fd) == keep.end()) ::close(fd);
+            }
+
+            bool clean = false;
+            try {
+                ShardWorker worker(seed, map_size, map_size, strip_begin(s, shard_count, map_size),
+                                   strip_begin(s + 1, shard_count, map_size), halo,
+                                   coordinator_links[s][1], neighbours, sides);
+                clean = worker.run();
+            } catch (...) {
+            }
+            ::_exit(clean ? 0 : 1);
+        }
+
+        for (int fd : all_fds) {
+            bool ours = false;
+            for (const auto& shard : shards) ours = ours || shard.fd == fd;
+            if (!ours) ::close(fd);
+        }
+
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (!shard::send(shards[s].fd, shard::Frame::Init, initial[s])) fail(s);
+        }
+    }
+
+public:
+    ShardedWorld(int npc_count, int map_size, uint64_t seed, int shard_count)
+        : map_size(map_size), npc_count(npc_count) {
+        if (shard_count <= 0 || map_size <= 0) throw std::invalid_argument("Need at least one shard and cell");
+        int widest_reach = npc_max_kill_distance();
+        for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) {
+            widest_reach = std::max(widest_reach, NPC_TYPE_INFO[i].move_distance);
+        }
+        if (map_size / shard_count < widest_reach) {
+            throw std::invalid_argument("Shard strips must be at least " + std::to_string(widest_reach) +
+                                        " cells wide");
+        }
+
+        std::vector<std::vector<ShardNPC>> initial(shard_count);
+        for (int i = 0; i < npc_count; ++i) {
+            auto spawn = AsyncGame::spawn_point(seed, static_cast<uint32_t>(i), map_size, map_size);
+            int s = shard_count - 1;
+            while (spawn.x < strip_begin(s, shard_count, map_size)) s--;
+            initial[s].push_back({static_cast<uint32_t>(i), spawn.x, spawn.y, spawn.type, 1});
+        }
+        alive.assign(npc_count, 1);
+        launch(seed, initial);
+    }
+
+    ShardedWorld(const ShardedWorld&) = delete;
+    ShardedWorld& operator=(const ShardedWorld&) = delete;
+
+    void step() {
+        std::vector<ShardBattle> battles, reported;
+        std::vector<uint32_t> report;
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (!shard::send(shards[s].fd, shard::Frame::Tick, std::vector<uint32_t>{})) fail(s);
+        }
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (!shard::receive(shards[s].fd, shard::Frame::Report, report) || report.size() != 2) fail(s);
+            handoffs += report[0];
+            ghosts += report[1];
+            if (!shard::receive(shards[s].fd, shard::Frame::Battles, reported)) fail(s);
+            battles.insert(battles.end(), reported.begin(), reported.end());
+        }
+
+        std::sort(battles.begin(), battles.end(), [](const ShardBattle& a, const ShardBattle& b) {
+            return a.attacker != b.attacker ? a.attacker < b.attacker : a.defender < b.defender;
+        });
+        std::vector<uint32_t> deaths;
+        for (const auto& battle : battles) {
+            if (!alive[battle.attacker] || !alive[battle.defender]) continue;
+            battles_resolved++;
+            if (!battle.kills) continue;
+            alive[battle.defender] = 0;
+            deaths.push_back(battle.defender);
+        }
+
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (!shard::send(shards[s].fd, shard::Frame::Deaths, deaths)) fail(s);
+        }
+        tick++;
+    }
+
+    // Every NPC, sorted by id.
+    std::vector<ShardNPC> collect() {
+        std::vector<ShardNPC> npcs, part;
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (!shard::send(shards[s].fd, shard::Frame::Collect, std::vector<uint32_t>{}) ||
+                !shard::receive(shards[s].fd, shard::Frame::State, part)) {
+                fail(s);
+            }
+            npcs.insert(npcs.end(), part.begin(), part.end());
+        }
+        std::sort(npcs.begin(), npcs.end(), [](const ShardNPC& a, const ShardNPC& b) { return a.id < b.id; });
+        return npcs;
+    }
+
+    size_t get_shard_count() const { return shards.size(); }
+    int get_npc_count() const { return npc_count; }
+    uint64_t get_tick() const { return tick; }
+    size_t get_battles_resolved() const { return battles_resolved; }
+    size_t get_handoffs() const { return handoffs; }
+    size_t get_ghosts() const { return ghosts; }
+
+    ~ShardedWorld() {
+        for (const auto& shard : shards) {
+            shard::send(shard.fd, shard::Frame::Stop, std::vector<uint32_t>{});
+            ::close(shard.fd);
+        }
+        for (const auto& shard : shards) {
+            int status = 0;
+            ::waitpid(shard.pid, &status, 0);
+        }
+    }
+};
+
+struct ShardCheck {
+    size_t npcs = 0;
+    size_t mismatches = 0;
+    size_t battles_single = 0;
+    size_t battles_sharded = 0;
+    size_t survivors = 0;
+    size_t handoffs = 0;
+    size_t ghosts = 0;
+    std::string first_mismatch;
+
+    bool matches() const { return mismatches == 0 && battles_single == battles_sharded; }
+};
+
+// Runs the same seed sharded and in one AsyncGame, then compares every NPC's
+// final position and liveness. The shards are forked before the single-process
+// game starts its threads.
+inline ShardCheck check_sharded_run(int npc_count, int map_size, uint64_t seed, int shard_count, uint64_t ticks) {
+    ShardCheck check;
+    std::vector<ShardNPC> sharded;
+    {
+        ShardedWorld world(npc_count, map_size, seed, shard_count);
+        for (uint64_t i = 0; i < ticks; ++i) world.step();
+        sharded = world.collect();
+        check.battles_sharded = world.get_battles_resolved();
+        check.handoffs = world.get_handoffs();
+        check.ghosts = world.get_ghosts();
+    }
+
+    AsyncGame game(npc_count, map_size, seed);
+    game.set_console_log(false);
+    for (uint64_t i = 0; i < ticks; ++i) game.step();
+    auto view = game.get_snapshot();
+    check.battles_single = game.get_battles_resolved();
+    check.survivors = view->alive_count;
+    check.npcs = view->size();
+
+    if (sharded.size() != view->size()) {
+        check.mismatches = std::max(sharded.size(), view->size());
+        check.first_mismatch = "sharded run returned " + std::to_string(sharded.size()) + " NPCs";
+        return check;
+    }
+    for (size_t id = 0; id < sharded.size(); ++id) {
+        const ShardNPC& npc = sharded[id];
+        bool same = npc.id == id && npc.x == view->x[id] && npc.y == view->y[id] &&
+                    static_cast<bool>(npc.alive) == static_cast<bool>(view->alive[id]);
+        if (same) continue;
+        if (check.mismatches++ == 0) {
+            check.first_mismatch = "NPC " + std::to_string(id) + ": sharded (" + std::to_string(npc.x) + ", " +
+                                   std::to_string(npc.y) + (npc.alive ? ", alive" : ", dead") +
+                                   "), single (" + std::to_string(view->x[id]) + ", " +
+                                   std::to_string(view->y[id]) + (view->alive[id] ? ", alive)" : ", dead)");
+        }
+    }
+    return check;
+}
+
+#endif
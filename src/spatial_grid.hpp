@@ -0,0 +1,123 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+class SpatialGrid {
+private:
+    int width;
+    int height;
+    int cell_size;
+    int cols;
+    int rows;
+
+    std::vector<std::vector<size_t>> cells;
+    std::vector<int> cell_of;
+    std::vector<size_t> index_in_cell;
+
+    static constexpr int NO_CELL = -1;
+
+    int cell_coord(int value, int limit) const {
+        int c = value / cell_size;
+        return std::max(0, std::min(limit - 1, c));
+    }
+
+    int cell_index(int x, int y) const {
+        return cell_coord(y, rows) * cols + cell_coord(x, cols);
+    }
+
+    void unlink(size_t id) {
+        auto& cell = cells[cell_of[id]];
+        size_t pos = index_in_cell[id];
+        size_t last = cell.back();
+        cell[pos] = last;
+        index_in_cell[last] = pos;
+        cell.pop_back();
+        cell_of[id] = NO_CELL;
+    }
+
+    void link(size_t id, int cell) {
+        cell_of[id] = cell;
+        index_in_cell[id] = cells[cell].size();
+        cells[cell].push_back(id);
+    }
+
+public:
+    SpatialGrid(int width, int height, int cell_size)
+        : width(width), height(height), cell_size(std::max(1, cell_size)) {
+        if (width <= 0 || height <= 0) {
+            throw std::invalid_argument("Grid dimensions must be positive");
+        }
+        cols = (width + this->cell_size - 1) / this->cell_size;
+        rows = (height + this->cell_size - 1) / this->cell_size;
+        cells.resize(static_cast<size_t>(cols) * rows);
+    }
+
+    int getCellSize() const { return cell_size; }
+    int getCols() const { return cols; }
+    int getRows() const { return rows; }
+
+    void insert(size_t id, int x, int y) {
+        if (id >= cell_of.size()) {
+            cell_of.resize(id + 1, NO_CELL);
+            index_in_cell.resize(id + 1, 0);
+        }
+        if (cell_of[id] != NO_CELL) unlink(id);
+        link(id, cell_index(x, y));
+    }
+
+    void remove(size_t id) {
+        if (id < cell_of.size() && cell_of[id] != NO_CELL) unlink(id);
+    }
+
+    void move(size_t id, int new_x, int new_y) {
+        int cell = cell_index(new_x, new_y);
+        if (cell_of[id] == cell) return;
+        unlink(id);
+        link(id, cell);
+    }
+
+    bool contains(size_t id) const {
+        return id < cell_of.size() && cell_of[id] != NO_CELL;
+    }
+
+    template <typename Fn>
+    void for_each_near(int x, int y, int radius, Fn&& fn) const {
+        int cx0 = cell_coord(x - radius, cols);
+        int cx1 = cell_coord(x + radius, cols);
+        int cy0 = cell_coord(y - radius, rows);
+        int cy1 = cell_coord(y + radius, rows);
+
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                for (size_t id : cells[cy * cols + cx]) {
+                    fn(id);
+                }
+            }
+        }
+    }
+
+    template <typename Fn>
+    void for_each_in_rows(int row_begin, int row_end, Fn&& fn) const {
+        row_begin = std::max(0, row_begin);
+        row_end = std::min(rows, row_end);
+        for (int cy = row_begin; cy < row_end; ++cy) {
+            for (int cx = 0; cx < cols; ++cx) {
+                for (size_t id : cells[cy * cols + cx]) {
+                    fn(id);
+                }
+            }
+        }
+    }
+
+    void clear() {
+        for (auto& cell : cells) cell.clear();
+        std::fill(cell_of.begin(), cell_of.end(), NO_CELL);
+    }
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Chrome trace-event recorder. Spans go into a buffer owned by the recording
+// thread, so recording takes no lock; write() must run once the traced threads
+// are idle. The TRACE_* macros and trace::acquire compile to nothing unless
+// BF3_TRACE is defined (cmake -DBF3_TRACE=ON).
+namespace trace {
+
+#ifdef BF3_TRACE
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+struct Record {
+    const char* name;
+    const char* category;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+struct ThreadBuffer {
+    static constexpr size_t MAX_RECORDS = 1 << 20;
+
+    uint32_t tid;
+    std::string name;
+    std::vector<Record> records;
+    size_t dropped = 0;
+};
+
+class Tracer {
+private:
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    static void append_json_string(std::string& out, const std::string& text) {
+        out += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        out += '"';
+    }
+
+    static void append_micros(std::string& out, uint64_t ns) {
+        out += std::to_string(ns / 1000);
+        out += '.';
+        std::string fraction = std::to_string(ns % 1000);
+        out.append(3 - fraction.size(), '0');
+        out += fraction;
+    }
+
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    // Buffers live as long as the tracer, so spans from finished threads are kept.
+    ThreadBuffer& local() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->tid = static_cast<uint32_t>(buffers.size());
+            buffer->name = "thread " + std::to_string(buffer->tid);
+        }
+        return *buffer;
+    }
+
+    uint64_t now_ns() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void set_thread_name(const char* name) { local().name = name; }
+
+    void record(const char* name, const char* category, uint64_t start_ns, uint64_t end_ns) {
+        ThreadBuffer& buffer = local();
+        if (buffer.records.size() >= ThreadBuffer::MAX_RECORDS) {
+            buffer.dropped++;
+            return;
+        }
+        buffer.records.push_back({name, category, start_ns, end_ns - start_ns});
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t total = 0;
+        for (const auto& buffer : buffers) total += buffer->records.size();
+        return total;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& buffer : buffers) {
+            buffer->records.clear();
+            buffer->dropped = 0;
+        }
+    }
+
+    // Complete ("X") events with timestamps in microseconds, plus thread_name
+    // metadata, loadable by chrome://tracing and Perfetto.
+    bool write(const std::string& filename) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string out = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        auto separator = [&]() {
+            out += first ? "\n" : ",\n";
+            first = false;
+        };
+
+        for (const auto& buffer : buffers) {
+            separator();
+            out += "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": " +
+                   std::to_string(buffer->tid) + ", \"args\": {\"name\": ";
+            append_json_string(out, buffer->name);
+            out += "}}";
+
+            for (const auto& record : buffer->records) {
+                separator();
+                out += "{\"ph\": \"X\", \"name\": ";
+                append_json_string(out, record.name);
+                out += ", \"cat\": ";
+                append_json_string(out, record.category);
+                out += ", \"pid\": 1, \"tid\": " + std::to_string(buffer->tid) + ", \"ts\": ";
+                append_micros(out, record.start_ns);
+                out += ", \"dur\": ";
+                append_micros(out, record.duration_ns);
+                out += '}';
+            }
+        }
+        out += "\n]}\n";
+
+        std::ofstream file(filename, std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        return static_cast<bool>(file);
+    }
+};
+
+class Span {
+private:
+    const char* name;
+    const char* category;
+    uint64_t start;
+
+public:
+    explicit Span(const char* name, const char* category = "phase")
+        : name(name), category(category), start(Tracer::instance().now_ns()) {}
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    ~Span() {
+        Tracer& tracer = Tracer::instance();
+        tracer.record(name, category, start, tracer.now_ns());
+    }
+};
+
+// Constructs `Lock` over `mutex`; when tracing, the wait for the mutex is
+// recorded as a "lock" span. Relies on guaranteed copy elision, so it works
+// for std::lock_guard as well: auto lock = trace::acquire<Guard>(m, "m");
+template <typename Lock, typename Mutex>
+inline Lock acquire(Mutex& mutex, const char* name) {
+#ifdef BF3_TRACE
+    Span span(name, "lock");
+#else
+    (void)name;
+#endif
+    return Lock(mutex);
+}
+
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef BF3_TRACE
+#define TRACE_SPAN(name) ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#define TRACE_THREAD(name) ::trace::Tracer::instance().set_thread_name(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+#endif
+
+#endif
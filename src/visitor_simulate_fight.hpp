@@ -5,6 +5,7 @@
 #include "rogue.hpp"
 #include "orc.hpp"
 #include "werewolf.hpp"
+#include "battle_table.hpp"
 #include <memory>
 
 class NPCVisitor {
@@ -22,51 +23,28 @@ private:
     double battleRange;
     bool battleOccurred;
     
+    void fight(NPC& target) {
+        if (!defender || !attacker->isAlive() || !target.isAlive()) return;
+        
+        if (attacker->distanceTo(target) > battleRange) return;
+        
+        if (canDefeat(attacker->getKind(), target.getKind())) {
+            target.die();
+            battleOccurred = true;
+        }
+    }
+    
 public:
     BattleVisitor(std::shared_ptr<NPC> attacker, double range)
         : attacker(attacker), battleRange(range), battleOccurred(false) {}
     
-    void setDefender(std::shared_ptr<NPC> def) { defender = def; }
+    void setDefender(std::shared_ptr<NPC> def) { defender = std::move(def); }
     bool didBattleOccur() const { return battleOccurred; }
     void reset() { battleOccurred = false; defender = nullptr; }
     
-    void visit(Rogue& rogue) override {
-        if (!defender || !attacker->isAlive() || !rogue.isAlive()) return;
-        
-        if (attacker->distanceTo(rogue) > battleRange) return;
-        
-        if (attacker->getType() == "Orc" && defender->getType() == "Rogue") {
-            if (rogue.isAlive()) {
-                rogue.die();
-                battleOccurred = true;
-            }
-        }
-        else if (attacker->getType() == "Werewolf" && defender->getType() == "Rogue") {
-            if (rogue.isAlive()) {
-                rogue.die();
-                battleOccurred = true;
-            }
-        }
-    }
-    
-    void visit(Orc& orc) override {
-        if (!defender || !attacker->isAlive() || !orc.isAlive()) return;
-        
-        if (attacker->distanceTo(orc) > battleRange) return;
-    }
-    
-    void visit(Werewolf& werewolf) override {
-        if (!defender || !attacker->isAlive() || !werewolf.isAlive()) return;
-        
-        if (attacker->distanceTo(werewolf) > battleRange) return;
-        
-        if (attacker->getType() == "Rogue" && defender->getType() == "Werewolf") {
-            if (werewolf.isAlive()) {
-                werewolf.die();
-                battleOccurred = true;
-            }
-        }
-    }
+    void visit(Rogue& rogue) override { fight(rogue); }
+    void visit(Orc& orc) override { fight(orc); }
+    void visit(Werewolf& werewolf) override { fight(werewolf); }
 };
 
 #endif
\ No newline at end of file
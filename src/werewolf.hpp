@@ -6,9 +6,9 @@
 class Werewolf : public NPC {
 public:
     Werewolf(const std::string& name, int x, int y);
+    Werewolf(std::string&& name, int x, int y) = delete;
     
     void accept(NPCVisitor& visitor) override;
-    std::string getType() const override { return "Werewolf"; }
 };
 
 #endif
\ No newline at end of file
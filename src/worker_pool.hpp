@@ -0,0 +1,91 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstddef>
+
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+
+    std::function<void(size_t)> task;
+    size_t generation = 0;
+    size_t pending = 0;
+    bool stopping = false;
+
+    void worker(size_t index) {
+        size_t seen = 0;
+        while (true) {
+            std::function<void(size_t)> current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!start_cv.wait_for(lock, std::chrono::milliseconds(100),
+                                          [&]() { return stopping || generation != seen; })) {}
+                if (stopping) return;
+                seen = generation;
+                current = task;
+            }
+
+            current(index);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done_cv.notify_one();
+        }
+    }
+
+public:
+    explicit WorkerPool(size_t count) {
+        if (count == 0) count = 1;
+        for (size_t i = 1; i < count; ++i) {
+            threads.emplace_back(&WorkerPool::worker, this, i);
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return threads.size() + 1; }
+
+    void run(const std::function<void(size_t)>& fn) {
+        if (threads.empty()) {
+            fn(0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = fn;
+            pending = threads.size();
+            ++generation;
+        }
+        start_cv.notify_all();
+
+        fn(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!done_cv.wait_for(lock, std::chrono::milliseconds(100),
+                                 [this]() { return pending == 0; })) {}
+        task = nullptr;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start_cv.notify_all();
+        for (auto& thread : threads) {
+            if (thread.joinable()) thread.join();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,287 @@
+#ifndef WORLD_FILE_HPP
+#define WORLD_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Columnar world snapshot:
+//   header | x:int32[n] | y:int32[n] | type:uint8[n] | alive:uint8[n]
+//   | name_offsets:uint32[n+1] | name pool | type_offsets:uint32[t+1] | type pool
+// Sections start on 8-byte boundaries. Type codes index the type dictionary
+// so each reader maps them onto its own enum by name.
+struct WorldFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t count;
+    uint64_t type_count;
+    uint64_t x_offset;
+    uint64_t y_offset;
+    uint64_t type_offset;
+    uint64_t alive_offset;
+    uint64_t name_offsets_offset;
+    uint64_t name_pool_offset;
+    uint64_t type_offsets_offset;
+    uint64_t type_pool_offset;
+    uint64_t file_size;
+    uint64_t checksum;
+};
+
+namespace world_file {
+
+constexpr char MAGIC[8] = {'B', 'F', '3', 'W', 'O', 'R', 'L', 'D'};
+constexpr uint32_t VERSION = 1;
+
+inline uint64_t checksum(const unsigned char* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t word;
+        std::memcpy(&word, data + i * 8, 8);
+        hash = (hash ^ word) * 0x100000001B3ull;
+        hash ^= hash >> 29;
+    }
+    for (size_t i = words * 8; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+inline bool has_magic(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(magic)) == 0;
+}
+
+}
+
+class WorldFileWriter {
+private:
+    std::vector<std::string> type_names;
+    std::vector<int32_t> xs;
+    std::vector<int32_t> ys;
+    std::vector<uint8_t> types;
+    std::vector<uint8_t> alive;
+    std::vector<uint32_t> name_offsets{0};
+    std::string name_pool;
+
+    static size_t align(size_t offset) { return (offset + 7) & ~static_cast<size_t>(7); }
+
+    uint8_t type_code(const std::string& type) {
+        for (size_t i = 0; i < type_names.size(); ++i) {
+            if (type_names[i] == type) return static_cast<uint8_t>(i);
+        }
+        if (type_names.size() == 256) throw std::length_error("Too many NPC types for a world file");
+        type_names.push_back(type);
+        return static_cast<uint8_t>(type_names.size() - 1);
+    }
+
+public:
+    void reserve(size_t count) {
+        xs.reserve(count);
+        ys.reserve(count);
+        types.reserve(count);
+        alive.reserve(count);
+        name_offsets.reserve(count + 1);
+    }
+
+    void add(const std::string& type, const std::string& name, int x, int y, bool is_alive) {
+        xs.push_back(x);
+        ys.push_back(y);
+        types.push_back(type_code(type));
+        alive.push_back(is_alive ? 1 : 0);
+        name_pool += name;
+        name_offsets.push_back(static_cast<uint32_t>(name_pool.size()));
+    }
+
+    size_t size() const { return xs.size(); }
+
+    bool save(const std::string& filename) const {
+        size_t count = xs.size();
+        std::vector<uint32_t> type_offsets{0};
+        std::string type_pool;
+        for (const auto& type : type_names) {
+            type_pool += type;
+            type_offsets.push_back(static_cast<uint32_t>(type_pool.size()));
+        }
+
+        WorldFileHeader header{};
+        std::memcpy(header.magic, world_file::MAGIC, sizeof(header.magic));
+        header.version = world_file::VERSION;
+        header.header_size = sizeof(WorldFileHeader);
+        header.count = count;
+        header.type_count = type_names.size();
+        header.x_offset = align(sizeof(WorldFileHeader));
+        header.y_offset = align(header.x_offset + count * sizeof(int32_t));
+        header.type_offset = align(header.y_offset + count * sizeof(int32_t));
+        header.alive_offset = align(header.type_offset + count);
+        header.name_offsets_offset = align(header.alive_offset + count);
+        header.name_pool_offset = align(header.name_offsets_offset + (count + 1) * sizeof(uint32_t));
+        header.type_offsets_offset = align(header.name_pool_offset + name_pool.size());
+        header.type_pool_offset = header.type_offsets_offset + type_offsets.size() * sizeof(uint32_t);
+        header.file_size = header.type_pool_offset + type_pool.size();
+
+        std::vector<unsigned char> image(header.file_size, 0);
+        auto put = [&](uint64_t offset, const void* data, size_t size) {
+            if (size) std::memcpy(image.data() + offset, data, size);
+        };
+        put(header.x_offset, xs.data(), count * sizeof(int32_t));
+        put(header.y_offset, ys.data(), count * sizeof(int32_t));
+        put(header.type_offset, types.data(), count);
+        put(header.alive_offset, alive.data(), count);
+        put(header.name_offsets_offset, name_offsets.data(), name_offsets.size() * sizeof(uint32_t));
+        put(header.name_pool_offset, name_pool.data(), name_pool.size());
+        put(header.type_offsets_offset, type_offsets.data(), type_offsets.size() * sizeof(uint32_t));
+        put(header.type_pool_offset, type_pool.data(), type_pool.size());
+
+        header.checksum = world_file::checksum(image.data() + sizeof(WorldFileHeader),
+                                               image.size() - sizeof(WorldFileHeader));
+        put(0, &header, sizeof(header));
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+        return static_cast<bool>(file);
+    }
+};
+
+// Read-only mapping of a world file. Column accessors point straight into the
+// mapping; nothing is parsed or copied on open beyond header validation.
+class WorldFile {
+private:
+    const unsigned char* base = nullptr;
+    size_t mapped_size = 0;
+    WorldFileHeader header{};
+
+    template <typename T>
+    const T* column(uint64_t offset) const {
+        return reinterpret_cast<const T*>(base + offset);
+    }
+
+    void unmap() {
+        if (base) munmap(const_cast<unsigned char*>(base), mapped_size);
+        base = nullptr;
+        mapped_size = 0;
+    }
+
+    bool fail(std::string& error, const std::string& message) {
+        unmap();
+        error = message;
+        return false;
+    }
+
+    bool section_fits(uint64_t offset, uint64_t size) const {
+        return offset <= header.file_size && size <= header.file_size - offset;
+    }
+
+public:
+    WorldFile() = default;
+    WorldFile(const WorldFile&) = delete;
+    WorldFile& operator=(const WorldFile&) = delete;
+    ~WorldFile() { unmap(); }
+
+    bool open(const std::string& filename, std::string& error) {
+        unmap();
+
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return fail(error, "cannot open " + filename);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(WorldFileHeader)) {
+            ::close(fd);
+            return fail(error, "file too small for a world header");
+        }
+
+        mapped_size = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            mapped_size = 0;
+            return fail(error, "mmap failed");
+        }
+        base = static_cast<const unsigned char*>(mapping);
+        std::memcpy(&header, base, sizeof(header));
+
+        if (std::memcmp(header.magic, world_file::MAGIC, sizeof(header.magic)) != 0) {
+            return fail(error, "not a world file");
+        }
+        if (header.version != world_file::VERSION) {
+            return fail(error, "unsupported world file version " + std::to_string(header.version));
+        }
+        if (header.header_size != sizeof(WorldFileHeader) || header.file_size != mapped_size) {
+            return fail(error, "truncated or resized world file");
+        }
+
+        uint64_t count = header.count;
+        if (count > mapped_size || header.type_count > 256 ||
+            !section_fits(header.x_offset, count * sizeof(int32_t)) ||
+            !section_fits(header.y_offset, count * sizeof(int32_t)) ||
+            !section_fits(header.type_offset, count) ||
+            !section_fits(header.alive_offset, count) ||
+            !section_fits(header.name_offsets_offset, (count + 1) * sizeof(uint32_t)) ||
+            !section_fits(header.type_offsets_offset, (header.type_count + 1) * sizeof(uint32_t)) ||
+            !section_fits(header.name_pool_offset, 0) || !section_fits(header.type_pool_offset, 0) ||
+            header.name_pool_offset > header.type_offsets_offset ||
+            header.x_offset % 8 || header.y_offset % 8 ||
+            header.name_offsets_offset % 8 || header.type_offsets_offset % 8) {
+            return fail(error, "world file sections out of bounds");
+        }
+
+        if (world_file::checksum(base + sizeof(WorldFileHeader), mapped_size - sizeof(WorldFileHeader)) !=
+            header.checksum) {
+            return fail(error, "world file checksum mismatch");
+        }
+
+        uint64_t name_pool_size = header.type_offsets_offset - header.name_pool_offset;
+        uint64_t type_pool_size = header.file_size - header.type_pool_offset;
+        if (name_offsets()[count] > name_pool_size || type_offsets()[header.type_count] > type_pool_size) {
+            return fail(error, "world file string pool out of bounds");
+        }
+        for (uint64_t code = 0; code < header.type_count; ++code) {
+            if (type_offsets()[code] > type_offsets()[code + 1]) {
+                return fail(error, "world file type " + std::to_string(code) + " is corrupt");
+            }
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            if (types()[i] >= header.type_count || name_offsets()[i] > name_offsets()[i + 1]) {
+                return fail(error, "world file record " + std::to_string(i) + " is corrupt");
+            }
+        }
+        return true;
+    }
+
+    bool is_open() const { return base != nullptr; }
+    size_t size() const { return static_cast<size_t>(header.count); }
+    size_t type_count() const { return static_cast<size_t>(header.type_count); }
+
+    const int32_t* xs() const { return column<int32_t>(header.x_offset); }
+    const int32_t* ys() const { return column<int32_t>(header.y_offset); }
+    const uint8_t* types() const { return column<uint8_t>(header.type_offset); }
+    const uint8_t* alive() const { return column<uint8_t>(header.alive_offset); }
+    const uint32_t* name_offsets() const { return column<uint32_t>(header.name_offsets_offset); }
+    const uint32_t* type_offsets() const { return column<uint32_t>(header.type_offsets_offset); }
+
+    std::string_view name(size_t slot) const {
+        const uint32_t* offsets = name_offsets();
+        return {reinterpret_cast<const char*>(base + header.name_pool_offset + offsets[slot]),
+                offsets[slot + 1] - offsets[slot]};
+    }
+
+    std::string_view type_name(size_t code) const {
+        const uint32_t* offsets = type_offsets();
+        return {reinterpret_cast<const char*>(base + header.type_pool_offset + offsets[code]),
+                offsets[code + 1] - offsets[code]};
+    }
+};
+
+#endif
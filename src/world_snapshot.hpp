@@ -0,0 +1,77 @@
+#ifndef WORLD_SNAPSHOT_HPP
+#define WORLD_SNAPSHOT_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include "world_store.hpp"
+#include "npc_types.hpp"
+
+struct WorldSnapshot {
+    uint64_t tick = 0;
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<uint8_t> alive;
+    std::vector<NPCType> type_id;
+    std::shared_ptr<const std::vector<std::string>> names;
+
+    size_t alive_count = 0;
+    size_t type_counts[NPC_TYPE_COUNT] = {};
+
+    size_t size() const { return x.size(); }
+    const std::string& name(size_t slot) const { return (*names)[slot]; }
+
+    void capture(const WorldStore& world, uint64_t at_tick) {
+        size_t count = world.size();
+        tick = at_tick;
+        names = world.names;
+        x.assign(world.x.begin(), world.x.end());
+        y.assign(world.y.begin(), world.y.end());
+        type_id.assign(world.type_id.begin(), world.type_id.end());
+        alive.resize(count);
+
+        alive_count = 0;
+        std::fill(std::begin(type_counts), std::end(type_counts), 0);
+        for (size_t id = 0; id < count; ++id) {
+            alive[id] = world.alive[id];
+            if (!alive[id]) continue;
+            alive_count++;
+            if (npc_type_valid(type_id[id])) type_counts[npc_type_index(type_id[id])]++;
+        }
+    }
+};
+
+// Single-writer publisher. Readers take a reference-counted frozen view;
+// the writer refills whichever buffer no reader still holds.
+class SnapshotPublisher {
+private:
+    std::shared_ptr<const WorldSnapshot> current;
+    std::shared_ptr<WorldSnapshot> spare;
+
+public:
+    std::shared_ptr<const WorldSnapshot> acquire() const {
+        return std::atomic_load(&current);
+    }
+
+    void publish(const WorldStore& world, uint64_t tick) {
+        std::shared_ptr<WorldSnapshot> next;
+        if (spare && spare.use_count() == 1) {
+            next = std::move(spare);
+        } else {
+            next = std::make_shared<WorldSnapshot>();
+        }
+        spare.reset();
+
+        next->capture(world, tick);
+
+        auto previous = std::atomic_exchange(&current, std::shared_ptr<const WorldSnapshot>(next));
+        spare = std::const_pointer_cast<WorldSnapshot>(previous);
+    }
+};
+
+#endif
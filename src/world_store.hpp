@@ -0,0 +1,88 @@
+#ifndef WORLD_STORE_HPP
+#define WORLD_STORE_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include "npc_types.hpp"
+
+class AliveFlag {
+private:
+    std::atomic<uint8_t> value;
+
+public:
+    AliveFlag(uint8_t initial = 1) : value(initial) {}
+    AliveFlag(const AliveFlag& other) : value(other.value.load(std::memory_order_relaxed)) {}
+
+    AliveFlag& operator=(const AliveFlag& other) {
+        value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    AliveFlag& operator=(uint8_t flag) {
+        value.store(flag, std::memory_order_release);
+        return *this;
+    }
+
+    operator uint8_t() const { return value.load(std::memory_order_acquire); }
+
+    bool kill() {
+        uint8_t expected = 1;
+        return value.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+    }
+};
+
+class WorldStore {
+public:
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<AliveFlag> alive;
+    std::vector<NPCType> type_id;
+
+    // Shared with published snapshots, so it is copied or replaced rather than
+    // modified while a snapshot still holds it.
+    std::shared_ptr<std::vector<std::string>> names = std::make_shared<std::vector<std::string>>();
+
+    size_t size() const { return x.size(); }
+
+    const std::string& name(size_t slot) const { return (*names)[slot]; }
+
+    std::vector<std::string>& own_names() {
+        if (names.use_count() > 1) names = std::make_shared<std::vector<std::string>>(*names);
+        return *names;
+    }
+
+    void reserve(size_t count) {
+        x.reserve(count);
+        y.reserve(count);
+        alive.reserve(count);
+        type_id.reserve(count);
+        own_names().reserve(count);
+    }
+
+    const std::string& type_name(size_t slot) const {
+        return npc_type_name(type_id[slot]);
+    }
+
+    size_t add(const std::string& name, NPCType type, int new_x, int new_y) {
+        x.push_back(new_x);
+        y.push_back(new_y);
+        alive.push_back(1);
+        type_id.push_back(type);
+        own_names().push_back(name);
+        return x.size() - 1;
+    }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        alive.clear();
+        type_id.clear();
+        names = std::make_shared<std::vector<std::string>>();
+    }
+};
+
+#endif
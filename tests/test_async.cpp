@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include "../src/async_game.hpp"
+#include "../src/sharded_world.hpp"
+#include <tuple>
+#include <set>
+#include <iterator>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 
 TEST(AsyncGameTest, Initialization) {
     AsyncGame game;
@@ -40,6 +47,29 @@ TEST(AsyncGameTest, BattleRules) {
     EXPECT_FALSE(game.can_kill("Pegasus", "Pegasus"));
 }
 
+TEST(NPCTypesTest, TablesMatchStringRules) {
+    EXPECT_EQ(parse_npc_type("Werewolf"), NPCType::Werewolf);
+    EXPECT_EQ(parse_npc_type("Dragon"), NPCType::None);
+    EXPECT_EQ(npc_type_name(NPCType::Pegasus), "Pegasus");
+    EXPECT_EQ(npc_glyph(NPCType::Orc), 'O');
+    EXPECT_EQ(npc_max_kill_distance(), 10);
+    
+    const std::set<std::pair<std::string, std::string>> kills = {
+        {"Rogue", "Werewolf"},
+        {"Werewolf", "Rogue"},
+        {"Orc", "Rogue"},
+    };
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a) {
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d) {
+            bool expected = kills.count({NPC_TYPE_INFO[a].name, NPC_TYPE_INFO[d].name}) > 0;
+            EXPECT_EQ(npc_can_kill(npc_type_at(a), npc_type_at(d)), expected)
+                << NPC_TYPE_INFO[a].name << " vs " << NPC_TYPE_INFO[d].name;
+        }
+    }
+    EXPECT_FALSE(npc_can_kill(NPCType::None, NPCType::Rogue));
+    EXPECT_FALSE(npc_can_kill(NPCType::Rogue, NPCType::None));
+}
+
 TEST(AsyncGameTest, DiceRollRange) {
     AsyncGame game;
     
@@ -50,6 +80,387 @@ TEST(AsyncGameTest, DiceRollRange) {
     }
 }
 
+TEST(AsyncGameTest, GridTargetsMatchBruteForce) {
+    AsyncGame game(500);
+    
+    for (int sweep = 0; sweep < 3; ++sweep) {
+        game.movement_sweep();
+        
+        for (size_t id = 0; id < game.get_npc_count(); ++id) {
+            auto npc = game.get_npc(id);
+            int kill_dist = game.get_kill_distance(npc.type);
+            
+            std::vector<size_t> expected;
+            for (size_t other_id = 0; other_id < game.get_npc_count(); ++other_id) {
+                auto other = game.get_npc(other_id);
+                if (other_id == id || !other.isAlive()) continue;
+                if (npc.distanceTo(other) <= kill_dist) expected.push_back(other_id);
+            }
+            
+            EXPECT_EQ(game.find_targets(id), expected);
+        }
+    }
+}
+
+TEST(AsyncGameTest, ParallelMovementKeepsGridConsistent) {
+    AsyncGame game(2000, 200);
+    game.set_movement_workers(4);
+    EXPECT_EQ(game.get_movement_workers(), 4);
+    
+    for (int sweep = 0; sweep < 5; ++sweep) {
+        game.movement_sweep();
+    }
+    
+    for (size_t id = 0; id < game.get_npc_count(); ++id) {
+        auto npc = game.get_npc(id);
+        EXPECT_GE(npc.getX(), 0);
+        EXPECT_LT(npc.getX(), 200);
+        EXPECT_GE(npc.getY(), 0);
+        EXPECT_LT(npc.getY(), 200);
+        
+        int kill_dist = game.get_kill_distance(npc.type);
+        size_t expected = 0;
+        for (size_t other_id = 0; other_id < game.get_npc_count(); ++other_id) {
+            auto other = game.get_npc(other_id);
+            if (other_id != id && other.isAlive() && npc.distanceTo(other) <= kill_dist) expected++;
+        }
+        EXPECT_EQ(game.find_targets(id).size(), expected);
+    }
+}
+
+TEST(AsyncGameTest, ConcurrentResolversKillDefenderOnce) {
+    AsyncGame game(10);
+    std::atomic<int> kills{0};
+    std::vector<std::thread> resolvers;
+    
+    for (size_t attacker = 1; attacker < 9; ++attacker) {
+        resolvers.emplace_back([&game, &kills, attacker]() {
+            if (game.resolve_battle(attacker, 0, 6, 1) == AsyncGame::BattleResult::Killed) kills++;
+        });
+    }
+    for (auto& resolver : resolvers) resolver.join();
+    
+    EXPECT_EQ(kills, 1);
+    EXPECT_FALSE(game.get_npc(0).isAlive());
+    
+    game.get_npc(1).die();
+    EXPECT_EQ(game.resolve_battle(1, 2, 6, 1), AsyncGame::BattleResult::Skipped);
+    EXPECT_TRUE(game.get_npc(2).isAlive());
+}
+
+TEST(AsyncGameTest, BatchTakesEveryBattleFromTheLastSweep) {
+    AsyncGame game(500);
+    game.set_console_log(false);
+    
+    game.movement_sweep();
+    game.movement_sweep();
+    size_t found = game.get_sweep_battles();
+    EXPECT_GT(found, 0u);
+    
+    EXPECT_EQ(game.resolve_battle_batch(), found);
+    EXPECT_EQ(game.get_sweep_battles(), 0u);
+    EXPECT_EQ(game.resolve_battle_batch(), 0u);
+}
+
+TEST(AsyncGameTest, HeadlessRunAdvancesTicks) {
+    AsyncGame game(300);
+    game.set_console_log(false);
+    
+    auto stats = game.run_headless(50);
+    
+    EXPECT_EQ(stats.ticks, 50u);
+    EXPECT_EQ(game.get_tick(), 50u);
+    EXPECT_GT(stats.battles_resolved, 0u);
+    EXPECT_EQ(stats.survivors, game.get_alive_count());
+    EXPECT_LT(stats.survivors, 300u);
+    EXPECT_EQ(game.get_sweep_battles(), 0u);
+}
+
+static std::vector<std::tuple<int, int, bool>> headless_world(uint64_t seed, int workers) {
+    AsyncGame game(1000, 150, seed);
+    game.set_console_log(false);
+    game.set_movement_workers(workers);
+    game.run_headless(40);
+    
+    std::vector<std::tuple<int, int, bool>> state;
+    for (size_t id = 0; id < game.get_npc_count(); ++id) {
+        auto npc = game.get_npc(id);
+        state.emplace_back(npc.getX(), npc.getY(), npc.isAlive());
+    }
+    return state;
+}
+
+TEST(AsyncGameTest, SeededRunIsReproducibleAcrossWorkerCounts) {
+    auto single = headless_world(1234, 1);
+    
+    EXPECT_EQ(single, headless_world(1234, 1));
+    EXPECT_EQ(single, headless_world(1234, 3));
+    EXPECT_NE(single, headless_world(4321, 1));
+}
+
+TEST(CounterRngTest, DrawsDependOnlyOnKey) {
+    CounterRng first(7, CounterRng::Movement, 3, 11);
+    CounterRng second(7, CounterRng::Movement, 3, 11);
+    CounterRng other_tick(7, CounterRng::Movement, 4, 11);
+    
+    uint32_t a = first.next();
+    EXPECT_EQ(a, second.next());
+    EXPECT_NE(a, other_tick.next());
+    
+    int counts[3] = {0, 0, 0};
+    CounterRng rng(99, CounterRng::Dice, 0, 0);
+    for (int i = 0; i < 3000; ++i) {
+        int value = rng.uniform(-1, 1);
+        ASSERT_GE(value, -1);
+        ASSERT_LE(value, 1);
+        counts[value + 1]++;
+    }
+    for (int count : counts) EXPECT_GT(count, 800);
+}
+
+TEST(AsyncGameTest, SnapshotsStayFrozenWhileHeld) {
+    AsyncGame game(200, 100, 77);
+    game.set_console_log(false);
+    
+    auto initial = game.get_snapshot();
+    ASSERT_EQ(initial->size(), 200u);
+    EXPECT_EQ(initial->tick, 0u);
+    EXPECT_EQ(initial->alive_count, 200u);
+    std::vector<int> xs = initial->x;
+    
+    game.run_headless(10);
+    
+    auto latest = game.get_snapshot();
+    EXPECT_EQ(latest->tick, 10u);
+    EXPECT_NE(latest.get(), initial.get());
+    EXPECT_EQ(initial->x, xs);
+    EXPECT_EQ(latest->alive_count, game.get_alive_count());
+    
+    size_t type_total = 0;
+    for (size_t i = 0; i < NPC_TYPE_COUNT; ++i) type_total += latest->type_counts[i];
+    EXPECT_EQ(type_total, latest->alive_count);
+}
+
+static void expect_map_matches_snapshot(AsyncGame& game) {
+    auto view = game.get_snapshot();
+    MapRenderer::Viewport viewport = game.get_viewport();
+    
+    for (int row = 0; row < viewport.rows; ++row) {
+        for (int col = 0; col < viewport.cols; ++col) {
+            size_t best = NPC_TYPE_COUNT;
+            for (size_t id = 0; id < view->size(); ++id) {
+                if (!view->alive[id]) continue;
+                int dx = view->x[id] - viewport.x;
+                int dy = view->y[id] - viewport.y;
+                if (dx < 0 || dy < 0 || dx / viewport.zoom != col || dy / viewport.zoom != row) continue;
+                best = std::min(best, npc_type_index(view->type_id[id]));
+            }
+            char expected = best == NPC_TYPE_COUNT ? '.' : NPC_TYPE_INFO[best].glyph;
+            EXPECT_EQ(game.get_map_glyph(col, row), expected) << "cell " << col << "," << row;
+        }
+    }
+}
+
+TEST(AsyncGameTest, IncrementalMapMatchesSnapshot) {
+    AsyncGame game(400, 100, 5);
+    game.set_console_log(false);
+    
+    EXPECT_EQ(game.get_viewport().zoom, 5);
+    EXPECT_EQ(game.get_viewport().cols, 20);
+    expect_map_matches_snapshot(game);
+    
+    game.run_headless(25);
+    ASSERT_LT(game.get_alive_count(), 400u);
+    expect_map_matches_snapshot(game);
+    
+    game.set_viewport({40, 30, 12, 8, 2});
+    expect_map_matches_snapshot(game);
+    
+    game.run_headless(10);
+    expect_map_matches_snapshot(game);
+    
+    EXPECT_THROW(game.set_viewport({0, 0, 0, 10, 1}), std::invalid_argument);
+}
+
+TEST(WorldFileTest, RejectsStringPoolsOutsideTheFile) {
+    const std::string filename = "test_pools.bfw";
+    WorldFileWriter writer;
+    writer.add("Orc", "grom", 1, 2, true);
+    writer.add("Rogue", "shadow", 3, 4, false);
+    ASSERT_TRUE(writer.save(filename));
+    
+    std::string original;
+    {
+        std::ifstream in(filename, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto open_with = [&](const std::function<void(WorldFileHeader&, std::string&)>& patch) {
+        std::string bytes = original;
+        WorldFileHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        patch(header, bytes);
+        std::memcpy(&bytes[0], &header, sizeof(header));
+        std::ofstream(filename, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+        
+        WorldFile file;
+        std::string error;
+        file.open(filename, error);
+        return error;
+    };
+    
+    EXPECT_EQ(open_with([](WorldFileHeader&, std::string&) {}), "");
+    EXPECT_EQ(open_with([](WorldFileHeader& header, std::string&) {
+        header.name_pool_offset = header.type_offsets_offset + 8;
+    }), "world file sections out of bounds");
+    EXPECT_EQ(open_with([](WorldFileHeader& header, std::string&) {
+        header.type_pool_offset = header.file_size + 1;
+    }), "world file sections out of bounds");
+    EXPECT_EQ(open_with([](WorldFileHeader& header, std::string& bytes) {
+        uint32_t* offsets = reinterpret_cast<uint32_t*>(&bytes[header.type_offsets_offset]);
+        offsets[1] = offsets[2] + 1;
+        header.checksum = world_file::checksum(reinterpret_cast<const unsigned char*>(bytes.data()) +
+                                               sizeof(WorldFileHeader), bytes.size() - sizeof(WorldFileHeader));
+    }), "world file type 1 is corrupt");
+    std::remove(filename.c_str());
+}
+
+TEST(WorldFileTest, AsyncGameRoundTrip) {
+    const std::string filename = "test_world.bfw";
+    AsyncGame source(300, 100, 21);
+    source.set_console_log(false);
+    source.run_headless(15);
+    ASSERT_TRUE(source.save_world(filename));
+    
+    AsyncGame target(5, 100, 21);
+    target.set_console_log(false);
+    auto before = target.get_snapshot();
+    std::string old_name = before->name(4);
+    std::string error;
+    ASSERT_TRUE(target.load_world(filename, error)) << error;
+    ASSERT_EQ(before->names->size(), 5u);
+    EXPECT_EQ(before->name(4), old_name);
+    
+    auto expected = source.get_snapshot();
+    auto loaded = target.get_snapshot();
+    ASSERT_EQ(loaded->size(), expected->size());
+    EXPECT_EQ(loaded->x, expected->x);
+    EXPECT_EQ(loaded->y, expected->y);
+    EXPECT_EQ(loaded->alive, expected->alive);
+    EXPECT_EQ(loaded->type_id, expected->type_id);
+    EXPECT_EQ(loaded->name(299), expected->name(299));
+    EXPECT_EQ(target.get_alive_count(), source.get_alive_count());
+    
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(sizeof(WorldFileHeader) + 5);
+    file.put('\x7f');
+    file.close();
+    EXPECT_FALSE(target.load_world(filename, error));
+    EXPECT_EQ(error, "world file checksum mismatch");
+    EXPECT_EQ(target.get_npc_count(), 300u);
+    
+    std::remove(filename.c_str());
+}
+
+TEST(EventLogTest, FormatsBattleRecords) {
+    WorldStore world;
+    world.add("Shadow", NPCType::Rogue, 0, 0);
+    world.add("Fenrir", NPCType::Werewolf, 1, 1);
+    
+    std::string text;
+    event_log::format(text, event_log::make_battle_event(LogEventKind::Kill, 0, 0, 1, 5, 2), &world);
+    event_log::format(text, event_log::make_battle_event(LogEventKind::FailedKill, 0, 1, 0, 3, 3), nullptr);
+    
+    EXPECT_EQ(text, "[LOG] Rogue Shadow killed Werewolf Fenrir (5 vs 2)\n"
+                    "[LOG] NPC #1 failed to kill NPC #0 (3 vs 3)\n");
+}
+
+TEST(EventLogTest, BinaryLogRoundTrip) {
+    const std::string filename = "test_events.bin";
+    {
+        AsyncGame game(10);
+        ASSERT_TRUE(game.set_binary_log(filename));
+        EXPECT_EQ(game.drain_log(), 1u);
+    }
+    
+    auto events = event_log::read_binary(filename);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].kind, LogEventKind::GameInitialized);
+    EXPECT_EQ(events[0].value, 10u);
+    std::remove(filename.c_str());
+}
+
+TEST(EventLogTest, BusyTickLogsEveryBattle) {
+    const std::string filename = "test_busy_events.bin";
+    size_t battles = 0;
+    {
+        AsyncGame game(30000, 400, 99);
+        game.set_console_log(false);
+        ASSERT_TRUE(game.set_binary_log(filename));
+        game.step();
+        battles = game.get_battles_resolved();
+    }
+    
+    auto events = event_log::read_binary(filename);
+    EXPECT_GT(battles, size_t{1} << 14);
+    EXPECT_EQ(events.size(), battles + 1);
+    std::remove(filename.c_str());
+}
+
+TEST(MPMCQueueTest, ProducersAndConsumersSeeEveryItem) {
+    MPMCQueue<int> queue(1024);
+    const int per_producer = 10000;
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+    std::vector<std::thread> threads;
+    
+    for (int p = 0; p < 4; ++p) {
+        threads.emplace_back([&queue]() {
+            for (int i = 1; i <= per_producer; ++i) {
+                while (!queue.try_push(i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < 4; ++c) {
+        threads.emplace_back([&]() {
+            int value;
+            while (popped < 4 * per_producer) {
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    
+    EXPECT_EQ(sum, 4LL * per_producer * (per_producer + 1) / 2);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpatialGridTest, IncrementalMove) {
+    SpatialGrid grid(100, 100, 10);
+    grid.insert(0, 5, 5);
+    grid.insert(1, 95, 95);
+    
+    auto collect = [&grid](int x, int y, int r) {
+        std::vector<size_t> ids;
+        grid.for_each_near(x, y, r, [&ids](size_t id) { ids.push_back(id); });
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    
+    EXPECT_EQ(collect(0, 0, 10), std::vector<size_t>({0}));
+    
+    grid.move(1, 12, 3);
+    EXPECT_EQ(collect(0, 0, 10), std::vector<size_t>({0, 1}));
+    EXPECT_TRUE(collect(95, 95, 10).empty());
+    
+    grid.remove(0);
+    EXPECT_EQ(collect(0, 0, 10), std::vector<size_t>({1}));
+}
+
 TEST(AsyncNPCTest, Creation) {
     auto npc = std::make_shared<AsyncNPC>("Test", 100, 200);
     npc->type = "Rogue";
@@ -109,7 +520,153 @@ TEST(AsyncNPCTest, TypeAssignment) {
     EXPECT_EQ(npc->getType(), "Werewolf");
 }
 
+TEST(AsyncNPCTest, ViewOverWorldStore) {
+    WorldStore world;
+    size_t id = world.add("Viewed", NPCType::Orc, 10, 20);
+    
+    AsyncNPC view(world, id);
+    EXPECT_EQ(view.getName(), "Viewed");
+    EXPECT_EQ(view.getType(), "Orc");
+    
+    view.setPosition(30, 40);
+    view.die();
+    EXPECT_EQ(world.x[id], 30);
+    EXPECT_EQ(world.y[id], 40);
+    EXPECT_EQ(world.alive[id], 0);
+    
+    view.type = "Rogue";
+    EXPECT_EQ(world.type_name(id), "Rogue");
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
+TEST(MetricsTest, ShardedCountersAndHistogramsAggregate) {
+    MetricsRegistry registry;
+    Counter& events = registry.counter("test_events_total", "Events");
+    Histogram& latency = registry.histogram("test_latency_seconds", "Latency", {1000, 1000000});
+    double depth = 7;
+    registry.probe("test_depth", "Depth", MetricsRegistry::Type::Gauge, [&]() { return depth; });
+    EXPECT_THROW(registry.counter("test_events_total", "Again"), std::invalid_argument);
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i) {
+                events.add();
+                latency.observe(i < 500 ? 10 : 5000);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    latency.observe(2000000);
+    
+    EXPECT_EQ(events.value(), 4000u);
+    auto totals = latency.totals();
+    EXPECT_EQ(totals.cumulative, (std::vector<uint64_t>{2000, 4000, 4001}));
+    EXPECT_EQ(totals.sum, 2000u * 10 + 2000u * 5000 + 2000000);
+    
+    std::string text = registry.prometheus();
+    EXPECT_NE(text.find("# TYPE test_events_total counter\ntest_events_total 4000\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"1e-06\"} 2000\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"+Inf\"} 4001\n"), std::string::npos);
+    EXPECT_NE(text.find("test_depth 7\n"), std::string::npos);
+    EXPECT_NE(registry.json().find("\"test_events_total\": 4000"), std::string::npos);
+}
+
+TEST(MetricsTest, AsyncGameReportsSweepsAndBattles) {
+    AsyncGame game(400, 60, 99);
+    game.set_console_log(false);
+    for (int i = 0; i < 5; ++i) game.step();
+    
+    const std::string filename = "test_async_metrics.prom";
+    ASSERT_TRUE(game.get_metrics().write(filename));
+    std::ifstream file(filename);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(filename.c_str());
+    
+    EXPECT_NE(text.find("async_sweeps_total 5\n"), std::string::npos);
+    EXPECT_NE(text.find("async_sweep_seconds_count 5\n"), std::string::npos);
+    EXPECT_NE(text.find("async_battles_resolved_total " + std::to_string(game.get_battles_resolved()) + "\n"),
+              std::string::npos);
+    EXPECT_EQ(text.find("async_pairs_checked_total 0\n"), std::string::npos);
+}
+
+TEST(TraceTest, SpansExportAsChromeTraceEvents) {
+    auto& tracer = trace::Tracer::instance();
+    tracer.clear();
+    
+    std::thread worker([&]() {
+        tracer.set_thread_name("worker");
+        trace::Span span("outer");
+        std::mutex mutex;
+        auto lock = trace::acquire<std::lock_guard<std::mutex>>(mutex, "test_mutex");
+        trace::Span inner("inner", "test");
+    });
+    worker.join();
+    EXPECT_EQ(tracer.size(), trace::enabled ? 3u : 2u);
+    
+    const std::string filename = "test_trace.json";
+    ASSERT_TRUE(tracer.write(filename));
+    std::ifstream file(filename);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(filename.c_str());
+    
+    EXPECT_EQ(text.rfind("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [", 0), 0u);
+    EXPECT_NE(text.find("\"args\": {\"name\": \"worker\"}"), std::string::npos);
+    EXPECT_NE(text.find("{\"ph\": \"X\", \"name\": \"inner\", \"cat\": \"test\""), std::string::npos);
+    EXPECT_NE(text.find("\"name\": \"outer\", \"cat\": \"phase\""), std::string::npos);
+    EXPECT_EQ(text.find("test_mutex") != std::string::npos, trace::enabled);
+    tracer.clear();
+}
+
+TEST(BattleBatchTest, OutcomeDoesNotDependOnWorkerCount) {
+    AsyncGame serial(4000, 150, 2024);
+    AsyncGame parallel(4000, 150, 2024);
+    serial.set_console_log(false);
+    parallel.set_console_log(false);
+    parallel.set_movement_workers(3);
+    parallel.set_battle_workers(4);
+    
+    for (int tick = 0; tick < 10; ++tick) {
+        serial.step();
+        parallel.step();
+        auto a = serial.get_snapshot();
+        auto b = parallel.get_snapshot();
+        ASSERT_EQ(a->x, b->x) << "tick " << tick;
+        ASSERT_EQ(a->y, b->y) << "tick " << tick;
+        ASSERT_EQ(a->alive, b->alive) << "tick " << tick;
+    }
+    EXPECT_GT(serial.get_battles_resolved(), 1000u);
+    EXPECT_EQ(serial.get_battles_resolved(), parallel.get_battles_resolved());
+}
+
+TEST(ShardedWorldTest, MatchesSingleProcessRun) {
+    ShardCheck check = check_sharded_run(600, 160, 4242, 3, 30);
+    
+    EXPECT_TRUE(check.matches()) << check.first_mismatch;
+    EXPECT_EQ(check.npcs, 600u);
+    EXPECT_EQ(check.battles_sharded, check.battles_single);
+    EXPECT_GT(check.battles_single, 0u);
+    EXPECT_LT(check.survivors, 600u);
+    EXPECT_GT(check.handoffs, 0u);
+    EXPECT_GT(check.ghosts, 0u);
+}
+
+TEST(ShardedWorldTest, MatchesWhenOneTickHasMoreBattlesThanAQueueWouldHold) {
+    ShardCheck check = check_sharded_run(100000, 400, 7, 2, 1);
+    
+    EXPECT_TRUE(check.matches()) << check.first_mismatch;
+    EXPECT_GT(check.battles_single, size_t{1} << 16);
+}
+
+TEST(ShardedWorldTest, RejectsStripsNarrowerThanAMove) {
+    EXPECT_THROW(ShardedWorld(100, 100, 1, 4), std::invalid_argument);
+    
+    ShardedWorld world(50, 100, 1, 2);
+    world.step();
+    auto npcs = world.collect();
+    ASSERT_EQ(npcs.size(), 50u);
+    for (size_t id = 0; id < npcs.size(); ++id) EXPECT_EQ(npcs[id].id, id);
+}
@@ -0,0 +1,546 @@
+#include <gtest/gtest.h>
+#include "core.hpp"
+#include <random>
+#include <fstream>
+#include <cstdio>
+#include <iterator>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+
+static const char* CORE_TYPES[] = {"Rogue", "Orc", "Werewolf"};
+
+static void write_dungeon(const std::string& filename, int npcs, int map_size, unsigned seed) {
+    std::ofstream file(filename);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<> coord(0, map_size);
+    for (int i = 0; i < npcs; ++i) {
+        const char* type = CORE_TYPES[rng() % 3];
+        file << type << "," << type << "_" << i << "," << coord(rng) << "," << coord(rng) << ",1\n";
+    }
+}
+
+// The pre-join pair loop, kept as the reference for battle outcomes.
+static std::string reference_battle(const std::string& filename, double range) {
+    std::vector<std::shared_ptr<NPC>> npcs;
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (auto npc = NPC::load(line)) npcs.push_back(npc);
+    }
+    
+    for (size_t i = 0; i < npcs.size(); i++) {
+        auto attacker = npcs[i];
+        if (!attacker->isAlive()) continue;
+        for (size_t j = 0; j < npcs.size(); j++) {
+            if (i == j || !npcs[j]->isAlive()) continue;
+            if (attacker->distanceTo(*npcs[j]) > range) continue;
+            BattleVisitor visitor(attacker, range);
+            visitor.setDefender(npcs[j]);
+            npcs[j]->accept(visitor);
+        }
+    }
+    
+    std::string info = "NPC Information:\n";
+    for (const auto& npc : npcs) {
+        if (!npc->isAlive()) continue;
+        info += "  " + npc->getType() + " '" + npc->getName() +
+               "' at (" + std::to_string(npc->getX()) + ", " +
+               std::to_string(npc->getY()) + ") - Alive\n";
+    }
+    return info;
+}
+
+TEST(CoreTest, RangeJoinMatchesPairLoop) {
+    const std::string filename = "test_core_dungeon.csv";
+    
+    for (double range : {0.0, 1.5, 7.0, 10.0, 25.0, 1000.0}) {
+        write_dungeon(filename, 600, 120, static_cast<unsigned>(range * 10) + 1);
+        
+        Core core;
+        core.setConsoleOutput(false);
+        core.setFileOutput(false);
+        ASSERT_TRUE(core.loadFromFile(filename));
+        core.simulateBattle(range);
+        
+        EXPECT_EQ(core.npcInfo(), reference_battle(filename, range)) << "range " << range;
+    }
+    std::remove(filename.c_str());
+}
+
+TEST(RangeJoinTest, ProducesEachPairOnce) {
+    std::vector<int> xs = {0, 3, 3, 10, 4, 0};
+    std::vector<int> ys = {0, 4, 4, 10, 0, 5};
+    
+    RangeJoin join(5.0);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    join.forEachPair(xs, ys, [&](uint32_t a, uint32_t b) { pairs.push_back({a, b}); });
+    std::sort(pairs.begin(), pairs.end());
+    
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    for (uint32_t a = 0; a < xs.size(); ++a) {
+        for (uint32_t b = a + 1; b < xs.size(); ++b) {
+            int dx = xs[a] - xs[b];
+            int dy = ys[a] - ys[b];
+            if (std::sqrt(dx*dx + dy*dy) <= 5.0) expected.push_back({a, b});
+        }
+    }
+    EXPECT_EQ(pairs, expected);
+    EXPECT_EQ(RangeJoin::squaredLimit(std::sqrt(2.0)), 2);
+    EXPECT_EQ(RangeJoin::squaredLimit(-1.0), -1);
+}
+
+class KindCounter : public NPCVisitor {
+public:
+    int rogues = 0;
+    int orcs = 0;
+    int werewolves = 0;
+    
+    void visit(Rogue&) override { rogues++; }
+    void visit(Orc&) override { orcs++; }
+    void visit(Werewolf&) override { werewolves++; }
+};
+
+TEST(BattleTableTest, KindsAndCustomVisitors) {
+    EXPECT_TRUE(canDefeat(NPCKind::Orc, NPCKind::Rogue));
+    EXPECT_TRUE(canDefeat(NPCKind::Werewolf, NPCKind::Rogue));
+    EXPECT_TRUE(canDefeat(NPCKind::Rogue, NPCKind::Werewolf));
+    EXPECT_FALSE(canDefeat(NPCKind::Rogue, NPCKind::Orc));
+    EXPECT_FALSE(canDefeat(NPCKind::Orc, NPCKind::Werewolf));
+    
+    KindCounter counter;
+    for (const char* type : CORE_TYPES) {
+        auto npc = NPCFactory::createNPC(type, std::string(type) + "_1", 1, 1);
+        EXPECT_EQ(npc->getType(), type);
+        npc->accept(counter);
+    }
+    EXPECT_EQ(counter.rogues, 1);
+    EXPECT_EQ(counter.orcs, 1);
+    EXPECT_EQ(counter.werewolves, 1);
+    
+    auto orc = NPCFactory::createNPC("Orc", "grunt", 0, 0);
+    auto rogue = NPCFactory::createNPC("Разбойник", "thief", 3, 4);
+    EXPECT_EQ(rogue->getKind(), NPCKind::Rogue);
+    BattleVisitor visitor(orc, 5.0);
+    visitor.setDefender(rogue);
+    rogue->accept(visitor);
+    EXPECT_TRUE(visitor.didBattleOccur());
+    EXPECT_FALSE(rogue->isAlive());
+}
+
+TEST(CoreTest, BinarySnapshotRoundTrip) {
+    const std::string csv = "test_core_world.csv";
+    const std::string binary = "test_core_world.bfw";
+    write_dungeon(csv, 500, 500, 9);
+    
+    Core source;
+    source.setConsoleOutput(false);
+    source.setFileOutput(false);
+    ASSERT_TRUE(source.loadFromFile(csv));
+    ASSERT_TRUE(source.saveToFile(binary));
+    EXPECT_TRUE(world_file::has_magic(binary));
+    
+    Core target;
+    target.setConsoleOutput(false);
+    target.setFileOutput(false);
+    ASSERT_TRUE(target.loadFromFile(binary));
+    EXPECT_EQ(target.npcInfo(), source.npcInfo());
+    EXPECT_FALSE(target.loadSnapshot(csv));
+    EXPECT_EQ(target.getNPCCount(), 500u);
+    
+    std::remove(csv.c_str());
+    std::remove(binary.c_str());
+}
+
+TEST(CsvLoaderTest, ChunksMergeInFileOrderWithLineNumbers) {
+    std::string text;
+    size_t lines = 0;
+    std::vector<size_t> badLines;
+    while (text.size() < 300000) {
+        lines++;
+        if (lines % 997 == 0) {
+            text += "Orc,broken," + std::to_string(lines) + ",x,1\n";
+            badLines.push_back(lines);
+        } else if (lines % 1009 == 0) {
+            text += "\r\n";
+        } else {
+            text += std::string(CORE_TYPES[lines % 3]) + ",npc_" + std::to_string(lines) + "," +
+                    std::to_string(lines % 501) + "," + std::to_string(lines % 7) + ",1\r\n";
+        }
+    }
+    text += "Dragon,smaug,1,1,1";
+    badLines.push_back(++lines);
+    
+    std::vector<CsvRecord> serial, parallel;
+    std::vector<CsvError> serialErrors, parallelErrors;
+    CsvLoader(1).parse(text, serial, serialErrors);
+    CsvLoader(4).parse(text, parallel, parallelErrors);
+    
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        ASSERT_EQ(parallel[i].line, serial[i].line);
+        ASSERT_EQ(parallel[i].name, serial[i].name);
+        ASSERT_EQ(parallel[i].x, serial[i].x);
+    }
+    EXPECT_EQ(serial[0].name, "npc_1");
+    EXPECT_EQ(serial[0].kind, NPCKind::Orc);
+    EXPECT_EQ(serial[0].y, 1);
+    
+    ASSERT_EQ(parallelErrors.size(), badLines.size());
+    for (size_t i = 0; i < badLines.size(); ++i) {
+        EXPECT_EQ(parallelErrors[i].line, badLines[i]);
+        EXPECT_EQ(serialErrors[i].line, badLines[i]);
+    }
+    EXPECT_EQ(parallelErrors[0].message, "bad y coordinate");
+    EXPECT_EQ(parallelErrors.back().message, "unknown NPC type");
+}
+
+TEST(CoreTest, LoadReportsMalformedLines) {
+    const std::string filename = "test_core_malformed.csv";
+    {
+        std::ofstream file(filename);
+        file << "Rogue,Shadow,50,50,1\n"
+             << "Orc,Grom,150\n"
+             << "Werewolf,Fenrir,900,250,1\n"
+             << "Orc,Grunt,10,20,0\n";
+    }
+    
+    Core core;
+    core.setConsoleOutput(false);
+    core.setFileOutput(false);
+    ASSERT_TRUE(core.loadFromFile(filename));
+    EXPECT_EQ(core.getNPCCount(), 2u);
+    EXPECT_EQ(core.getAliveCount(), 1u);
+    
+    const auto& errors = core.getLoadErrors();
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_EQ(errors[0].line, 2u);
+    EXPECT_EQ(errors[1].line, 3u);
+    std::remove(filename.c_str());
+}
+
+TEST(CoreTest, JournalRecoversSnapshotPlusTail) {
+    const std::string base = "test_core_journal";
+    std::remove((base + ".bfw").c_str());
+    std::remove((base + ".journal").c_str());
+    
+    std::string expected;
+    {
+        Core core;
+        core.setConsoleOutput(false);
+        core.setFileOutput(false);
+        ASSERT_TRUE(core.openJournal(base));
+        EXPECT_EQ(core.getNPCCount(), 0u);
+        
+        core.addNPC("Rogue", "Shadow", 10, 10);
+        core.addNPC("Orc", "Grom", 12, 10);
+        core.addNPC("Werewolf", "Fenrir", 300, 300);
+        ASSERT_TRUE(core.checkpoint());
+        
+        core.addNPC("Rogue", "Bandit", 100, 100);
+        core.moveNPC("Fenrir", 101, 100);
+        core.simulateBattle(5.0);
+        core.addNPC("Orc", "Late", 400, 400);
+        expected = core.npcInfo();
+    }
+    
+    {
+        std::ofstream torn(base + ".journal", std::ios::binary | std::ios::app);
+        torn.write("\x20\x00\x00\x00\x01", 5);
+    }
+    
+    Core recovered;
+    recovered.setConsoleOutput(false);
+    recovered.setFileOutput(false);
+    ASSERT_TRUE(recovered.openJournal(base));
+    EXPECT_EQ(recovered.npcInfo(), expected);
+    
+    recovered.clear();
+    recovered.addNPC("Orc", "Fresh", 1, 2);
+    expected = recovered.npcInfo();
+    recovered.closeJournal();
+    
+    Core again;
+    again.setConsoleOutput(false);
+    again.setFileOutput(false);
+    ASSERT_TRUE(again.openJournal(base));
+    EXPECT_EQ(again.npcInfo(), expected);
+    EXPECT_EQ(again.getNPCCount(), 1u);
+    
+    again.closeJournal();
+    std::remove((base + ".bfw").c_str());
+    std::remove((base + ".journal").c_str());
+}
+
+TEST(JournalTest, ClearRecordsCarryNoKind) {
+    const std::string filename = "test_clear.journal";
+    std::remove(filename.c_str());
+    std::vector<JournalEntry> replay;
+    std::string error;
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open(filename, replay, error)) << error;
+        journal.append(JournalOp::Add, NPCKind::Orc, "grom", 1, 2);
+        journal.append(JournalOp::Clear);
+    }
+    
+    std::ifstream in(filename, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    // magic, then [header:8][payload:10 + name] per record
+    size_t clearPayload = 8 + (8 + 10 + 4) + 8;
+    ASSERT_EQ(bytes.size(), clearPayload + 10);
+    EXPECT_EQ(static_cast<uint8_t>(bytes[clearPayload]), static_cast<uint8_t>(JournalOp::Clear));
+    EXPECT_EQ(static_cast<uint8_t>(bytes[clearPayload + 1]), 0xFF);
+    
+    Journal reopened;
+    ASSERT_TRUE(reopened.open(filename, replay, error)) << error;
+    ASSERT_EQ(replay.size(), 2u);
+    EXPECT_EQ(replay[0].kind, NPCKind::Orc);
+    EXPECT_EQ(replay[1].op, JournalOp::Clear);
+    EXPECT_TRUE(replay[1].name.empty());
+    reopened.close();
+    std::remove(filename.c_str());
+}
+
+TEST(CoreTest, NameIndexAndBatchAdd) {
+    Core core;
+    core.setConsoleOutput(false);
+    core.setFileOutput(false);
+    
+    std::vector<std::string> names;
+    for (int i = 0; i < 50000; ++i) names.push_back("npc_" + std::to_string(i));
+    std::vector<NPCSpec> batch;
+    for (int i = 0; i < 50000; ++i) {
+        batch.push_back({CORE_TYPES[i % 3], names[i], i % 501, (i / 501) % 501});
+    }
+    ASSERT_TRUE(core.addNPCs(batch));
+    EXPECT_EQ(core.getNPCCount(), 50000u);
+    
+    auto found = core.findNPC("npc_1234");
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->getX(), 1234 % 501);
+    EXPECT_EQ(found->getKind(), NPCKind::Orc);
+    EXPECT_EQ(core.findNPC("missing"), nullptr);
+    
+    EXPECT_FALSE(core.addNPC("Orc", "npc_7", 1, 1));
+    EXPECT_TRUE(core.moveNPC("npc_7", 2, 3));
+    EXPECT_EQ(core.findNPC("npc_7")->getY(), 3);
+    
+    std::vector<NPCSpec> bad = {
+        {"Orc", "fresh_1", 1, 1},
+        {"Dragon", "fresh_2", 1, 1},
+        {"Orc", "fresh_1", 2, 2},
+        {"Rogue", "npc_3", 2, 2},
+        {"Rogue", "fresh_3", 600, 2},
+    };
+    EXPECT_FALSE(core.addNPCs(bad));
+    EXPECT_EQ(core.getNPCCount(), 50000u);
+    EXPECT_EQ(core.findNPC("fresh_1"), nullptr);
+    
+    core.simulateBattle(1.0);
+    size_t survivors = 0;
+    for (const auto& name : names) {
+        auto npc = core.findNPC(name);
+        if (!npc) continue;
+        survivors++;
+        EXPECT_TRUE(npc->isAlive());
+        EXPECT_EQ(npc->getName(), name);
+    }
+    EXPECT_GT(survivors, 0u);
+    EXPECT_LT(survivors, 50000u);
+    EXPECT_EQ(survivors, core.getNPCCount());
+    EXPECT_TRUE(core.addNPC("Orc", "after_battle", 5, 5));
+    EXPECT_EQ(core.findNPC("after_battle")->getName(), "after_battle");
+    
+    core.clear();
+    EXPECT_EQ(core.findNPC("npc_1234"), nullptr);
+    EXPECT_TRUE(core.addNPC("Orc", "npc_1234", 1, 1));
+}
+
+TEST(NameIndexTest, GrowsOneInsertAtATime) {
+    std::vector<std::string> names;
+    names.reserve(1000);
+    NameIndex index;
+    for (int i = 0; i < 1000; ++i) {
+        names.push_back("n" + std::to_string(i));
+        ASSERT_TRUE(index.insert(names.back(), i));
+    }
+    EXPECT_FALSE(index.insert(names[10], 5));
+    EXPECT_TRUE(index.erase("n10"));
+    EXPECT_EQ(index.find("n10"), NameIndex::npos);
+    EXPECT_EQ(index.find("n999"), 999u);
+    EXPECT_EQ(index.size(), 999u);
+}
+
+TEST(NPCPoolTest, BatchSlabsOutliveThePoolUntilReleased) {
+    std::weak_ptr<NPC> watched;
+    std::vector<std::shared_ptr<NPC>> npcs(3000);
+    {
+        NPCPool pool;
+        std::vector<NPCSeed> seeds;
+        for (int i = 0; i < 3000; ++i) {
+            const std::string& name = pool.getNames().store("npc_" + std::to_string(i));
+            seeds.push_back({static_cast<NPCKind>(i % 3), &name, i % 501, 7, i % 2 == 0});
+        }
+        pool.createBatch(seeds.data(), seeds.size(), npcs.data());
+        EXPECT_EQ(pool.getSlabCount(), 3u);
+        watched = npcs[1500];
+    }
+    
+    EXPECT_EQ(npcs[1500]->getName(), "npc_1500");
+    EXPECT_EQ(npcs[1500]->getKind(), NPCKind::Rogue);
+    EXPECT_TRUE(npcs[1500]->isAlive());
+    EXPECT_FALSE(npcs[1501]->isAlive());
+    EXPECT_EQ(npcs[2999]->getX(), 2999 % 501);
+    
+    npcs.clear();
+    EXPECT_TRUE(watched.expired());
+}
+
+TEST(NPCPoolTest, StandaloneNPCsOwnTheirNames) {
+    auto orc = NPCFactory::createNPC("Orc", "loner", 4, 5);
+    auto rogue = NPCFactory::createNPC("Rogue", "drifter", 6, 7);
+    std::weak_ptr<NPC> watched = orc;
+    
+    EXPECT_EQ(orc->getName(), "loner");
+    EXPECT_EQ(rogue->getName(), "drifter");
+    EXPECT_EQ(orc->getKind(), NPCKind::Orc);
+    
+    orc.reset();
+    EXPECT_TRUE(watched.expired());
+    EXPECT_EQ(rogue->getName(), "drifter");
+}
+
+TEST(NPCPoolTest, NPCsRejectTemporaryNames) {
+    EXPECT_TRUE((std::is_constructible<Rogue, const std::string&, int, int>::value));
+    EXPECT_FALSE((std::is_constructible<Rogue, std::string, int, int>::value));
+    EXPECT_FALSE((std::is_constructible<Orc, const char*, int, int>::value));
+    EXPECT_FALSE((std::is_constructible<Werewolf, std::string&&, int, int>::value));
+}
+
+TEST(CoreTest, ClearReleasesPooledNPCs) {
+    Core core;
+    core.setConsoleOutput(false);
+    core.setFileOutput(false);
+    
+    std::vector<NPCSpec> batch = {{"Orc", "grom", 1, 1}, {"Rogue", "shadow", 2, 2}};
+    ASSERT_TRUE(core.addNPCs(batch));
+    std::weak_ptr<const NPC> grom = core.findNPC("grom");
+    ASSERT_FALSE(grom.expired());
+    
+    core.clear();
+    EXPECT_TRUE(grom.expired());
+}
+
+class RecordingObserver : public Observer {
+public:
+    std::vector<std::string> messages;
+    size_t batches = 0;
+    
+    void update(const Event& event) override { messages.push_back(renderEvent(event)); }
+    
+    void updateBatch(const std::vector<Event>& batch) override {
+        batches++;
+        for (const auto& event : batch) {
+            if (wants(event.kind)) update(event);
+        }
+    }
+};
+
+TEST(ObservableTest, AsyncDispatchKeepsOrderAndFlushes) {
+    Core core;
+    core.setConsoleOutput(false);
+    core.setFileOutput(false);
+    RecordingObserver recorder;
+    core.attach(&recorder);
+    
+    core.addNPC("Orc", "sync", 1, 1);
+    EXPECT_EQ(recorder.messages.size(), 1u);
+    EXPECT_EQ(recorder.batches, 0u);
+    
+    core.setAsync(true);
+    for (int i = 0; i < 500; ++i) core.addNPC("Rogue", "r_" + std::to_string(i), i % 501, 3);
+    core.flush();
+    ASSERT_EQ(recorder.messages.size(), 501u);
+    EXPECT_GE(recorder.batches, 1u);
+    EXPECT_LE(recorder.batches, 500u);
+    EXPECT_EQ(recorder.messages[1], "Added Rogue 'r_0' at (0, 3)");
+    EXPECT_EQ(recorder.messages[500], "Added Rogue 'r_499' at (499, 3)");
+    
+    core.addNPC("Orc", "late", 2, 2);
+    core.detach(&recorder);
+    EXPECT_EQ(recorder.messages.size(), 502u);
+    core.setAsync(false);
+}
+
+TEST(ObservableTest, ObserversChangeWhileNotifying) {
+    Observable events;
+    RecordingObserver steady;
+    RecordingObserver churn;
+    events.attach(&steady);
+    
+    std::atomic<bool> done{false};
+    std::thread changer([&]() {
+        while (!done) {
+            events.attach(&churn);
+            churn.subscribe(EventKind::Failure, false);
+            churn.setMinLevel(EventLevel::Warning);
+            events.detach(&churn);
+            churn.subscribe(EventKind::Failure, true);
+            churn.setMinLevel(EventLevel::Debug);
+        }
+    });
+    
+    for (int i = 0; i < 2000; ++i) {
+        if (events.wants(EventKind::Failure)) {
+            Event failure{EventKind::Failure};
+            failure.text = "event " + std::to_string(i);
+            events.notify(std::move(failure));
+        }
+    }
+    done = true;
+    changer.join();
+    
+    ASSERT_EQ(steady.messages.size(), 2000u);
+    EXPECT_EQ(steady.messages.back(), "event 1999");
+}
+
+TEST(ObservableTest, SubscriptionsAndLevelsFilterEvents) {
+    const std::string filename = "test_core_events.csv";
+    write_dungeon(filename, 300, 40, 11);
+    
+    Core core;
+    core.setConsoleOutput(false);
+    core.setFileOutput(false);
+    EXPECT_FALSE(core.wants(EventKind::Kill));
+    
+    RecordingObserver kills;
+    kills.setMinLevel(EventLevel::Debug);
+    for (EventKind kind : {EventKind::NPCAdded, EventKind::Loaded, EventKind::BattleStarted,
+                           EventKind::BattleFinished, EventKind::Failure}) {
+        kills.subscribe(kind, false);
+    }
+    RecordingObserver warnings;
+    warnings.setMinLevel(EventLevel::Warning);
+    core.attach(&kills);
+    core.attach(&warnings);
+    EXPECT_TRUE(core.wants(EventKind::Kill));
+    EXPECT_FALSE(core.wants(EventKind::Loaded));
+    
+    ASSERT_TRUE(core.loadFromFile(filename));
+    core.addNPC("Orc", "dup", 1, 1);
+    core.addNPC("Orc", "dup", 1, 1);
+    core.simulateBattle(10.0);
+    
+    ASSERT_FALSE(kills.messages.empty());
+    for (const auto& message : kills.messages) {
+        EXPECT_NE(message.find(" defeated "), std::string::npos) << message;
+    }
+    ASSERT_EQ(warnings.messages.size(), 1u);
+    EXPECT_EQ(warnings.messages[0], "Failed to add NPC: name 'dup' is already taken");
+    
+    core.detach(&kills);
+    core.detach(&warnings);
+    std::remove(filename.c_str());
+}